@@ -0,0 +1,172 @@
+#include "LoRa-RP2040-sim.h"
+#include <string.h>
+
+// Registradores do modelo (mesmos endereços de LoRa-RP2040.c)
+#define REG_FIFO                 0x00
+#define REG_OP_MODE              0x01
+#define REG_FRF_MSB              0x06
+#define REG_FRF_MID              0x07
+#define REG_FRF_LSB              0x08
+#define REG_PA_CONFIG            0x09
+#define REG_OCP                  0x0b
+#define REG_LNA                  0x0c
+#define REG_FIFO_ADDR_PTR        0x0d
+#define REG_FIFO_TX_BASE_ADDR    0x0e
+#define REG_FIFO_RX_BASE_ADDR    0x0f
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
+#define REG_IRQ_FLAGS            0x12
+#define REG_RX_NB_BYTES          0x13
+#define REG_PKT_SNR_VALUE        0x19
+#define REG_PKT_RSSI_VALUE       0x1a
+#define REG_MODEM_CONFIG_1       0x1d
+#define REG_MODEM_CONFIG_2       0x1e
+#define REG_PREAMBLE_LSB         0x21
+#define REG_PAYLOAD_LENGTH       0x22
+#define REG_SYNC_WORD            0x39
+#define REG_VERSION              0x42
+#define REG_PA_DAC               0x4d
+
+#define MODE_MASK                0x07
+#define MODE_STDBY               0x01
+#define MODE_TX                  0x03
+#define MODE_CAD                 0x07
+
+#define IRQ_CAD_DONE_MASK        0x04
+#define IRQ_TX_DONE_MASK         0x08
+#define IRQ_VALID_HEADER_MASK    0x10
+#define IRQ_RX_DONE_MASK         0x40
+
+void LoRa_sim_init(LoRa_sim_t *sim, uint32_t spi_frequency) {
+    memset(sim, 0, sizeof(*sim));
+    sim->spi_frequency = spi_frequency;
+    sim->cs_overhead_ns = 500;
+
+    sim->regs[REG_OP_MODE] = 0x09;
+    sim->regs[REG_FRF_MSB] = 0x6c;
+    sim->regs[REG_FRF_MID] = 0x80;
+    sim->regs[REG_PA_CONFIG] = 0x4f;
+    sim->regs[REG_OCP] = 0x2b;
+    sim->regs[REG_LNA] = 0x20;
+    sim->regs[REG_FIFO_TX_BASE_ADDR] = 0x80;
+    sim->regs[REG_MODEM_CONFIG_1] = 0x72;
+    sim->regs[REG_MODEM_CONFIG_2] = 0x70;
+    sim->regs[REG_PREAMBLE_LSB] = 0x08;
+    sim->regs[REG_PAYLOAD_LENGTH] = 0x01;
+    sim->regs[REG_SYNC_WORD] = 0x12;
+    sim->regs[REG_VERSION] = 0x12;
+    sim->regs[REG_PA_DAC] = 0x84;
+}
+
+void LoRa_sim_reset_counters(LoRa_sim_t *sim) {
+    sim->transactions = 0;
+    sim->read_transactions = 0;
+    sim->write_transactions = 0;
+    sim->bytes = 0;
+    sim->tx_packets = 0;
+}
+
+// Cada transação custa o endereço mais os dados no clock configurado
+static void account(LoRa_sim_t *sim, size_t size) {
+    sim->transactions++;
+    sim->bytes += size + 1;
+    if (sim->spi_frequency) {
+        uint64_t ns = (uint64_t)8 * (size + 1) * 1000000000ull / sim->spi_frequency + sim->cs_overhead_ns;
+        sim->now_us += (ns + 999) / 1000;
+    }
+}
+
+// Efeitos colaterais de uma escrita: modo do chip e flags write-1-to-clear
+static void write_one(LoRa_sim_t *sim, uint8_t address, uint8_t value) {
+    switch (address) {
+    case REG_FIFO:
+        sim->fifo[sim->regs[REG_FIFO_ADDR_PTR]++] = value;
+        break;
+    case REG_IRQ_FLAGS:
+        sim->regs[REG_IRQ_FLAGS] &= ~value;
+        break;
+    case REG_VERSION:
+    case REG_FIFO_RX_CURRENT_ADDR:
+    case REG_RX_NB_BYTES:
+    case REG_PKT_SNR_VALUE:
+    case REG_PKT_RSSI_VALUE:
+        // Somente leitura
+        break;
+    case REG_OP_MODE:
+        sim->regs[REG_OP_MODE] = value;
+        if ((value & MODE_MASK) == MODE_TX) {
+            // TX instantâneo: copia o pacote e volta para standby
+            uint8_t length = sim->regs[REG_PAYLOAD_LENGTH];
+            for (int i = 0; i < length; i++) {
+                sim->last_tx[i] = sim->fifo[(uint8_t)(sim->regs[REG_FIFO_TX_BASE_ADDR] + i)];
+            }
+            sim->last_tx_length = length;
+            sim->tx_packets++;
+            sim->regs[REG_IRQ_FLAGS] |= IRQ_TX_DONE_MASK;
+            sim->regs[REG_OP_MODE] = (value & ~MODE_MASK) | MODE_STDBY;
+        } else if ((value & MODE_MASK) == MODE_CAD) {
+            // Canal sempre livre no modelo
+            sim->regs[REG_IRQ_FLAGS] |= IRQ_CAD_DONE_MASK;
+            sim->regs[REG_OP_MODE] = (value & ~MODE_MASK) | MODE_STDBY;
+        }
+        break;
+    default:
+        sim->regs[address & 0x7f] = value;
+        break;
+    }
+}
+
+// Rajadas: a FIFO avança o ponteiro, os demais registradores o endereço
+static void sim_write_burst(void *context, uint8_t address, const uint8_t *buffer, size_t size) {
+    LoRa_sim_t *sim = (LoRa_sim_t *)context;
+    account(sim, size);
+    sim->write_transactions++;
+    for (size_t i = 0; i < size; i++) {
+        write_one(sim, address == REG_FIFO ? REG_FIFO : (uint8_t)((address + i) & 0x7f), buffer[i]);
+    }
+}
+
+static void sim_read_burst(void *context, uint8_t address, uint8_t *buffer, size_t size) {
+    LoRa_sim_t *sim = (LoRa_sim_t *)context;
+    account(sim, size);
+    sim->read_transactions++;
+    for (size_t i = 0; i < size; i++) {
+        if (address == REG_FIFO) {
+            buffer[i] = sim->fifo[sim->regs[REG_FIFO_ADDR_PTR]++];
+        } else {
+            buffer[i] = sim->regs[(address + i) & 0x7f];
+        }
+    }
+}
+
+static void sim_delay_us(void *context, uint32_t us) {
+    ((LoRa_sim_t *)context)->now_us += us;
+}
+
+static uint64_t sim_time_us(void *context) {
+    return ((LoRa_sim_t *)context)->now_us;
+}
+
+const LoRa_transport_t LoRa_sim_transport = {
+    sim_write_burst,
+    sim_read_burst,
+    sim_delay_us,
+    sim_time_us,
+};
+
+void LoRa_sim_inject_rx(LoRa_sim_t *sim, const uint8_t *data, size_t size, int8_t snr_q4, uint8_t rssi) {
+    uint8_t base = sim->regs[REG_FIFO_RX_BASE_ADDR];
+    for (size_t i = 0; i < size && i < 256; i++) {
+        sim->fifo[(uint8_t)(base + i)] = data[i];
+    }
+    sim->regs[REG_FIFO_RX_CURRENT_ADDR] = base;
+    sim->regs[REG_RX_NB_BYTES] = (uint8_t)size;
+    sim->regs[REG_PKT_SNR_VALUE] = (uint8_t)snr_q4;
+    sim->regs[REG_PKT_RSSI_VALUE] = rssi;
+    sim->regs[REG_IRQ_FLAGS] |= IRQ_RX_DONE_MASK | IRQ_VALID_HEADER_MASK;
+}
+
+size_t LoRa_sim_last_tx(LoRa_sim_t *sim, uint8_t *data, size_t size) {
+    size_t length = sim->last_tx_length < size ? sim->last_tx_length : size;
+    memcpy(data, sim->last_tx, length);
+    return length;
+}
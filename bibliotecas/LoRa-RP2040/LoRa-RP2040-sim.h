@@ -0,0 +1,43 @@
+#ifndef LORA_RP2040_SIM_H
+#define LORA_RP2040_SIM_H
+
+// Modelo em memória do SX1276 (registradores + FIFO) que implementa
+// LoRa_transport_t. Não depende do Pico SDK: compila em Linux para testar a
+// lógica do protocolo, contar transações SPI e medir latência sem hardware.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "LoRa-RP2040-transport.h"
+
+typedef struct {
+    uint8_t regs[0x80];
+    uint8_t fifo[256];
+    uint64_t now_us;           // relógio virtual
+    uint32_t spi_frequency;    // custo de tempo de cada byte no barramento
+    uint32_t cs_overhead_ns;   // custo fixo por transação (CS + setup)
+
+    // Contadores para regressões de desempenho
+    uint32_t transactions;
+    uint32_t read_transactions;
+    uint32_t write_transactions;
+    uint32_t bytes;
+    uint32_t tx_packets;
+
+    uint8_t last_tx[256];
+    size_t last_tx_length;
+} LoRa_sim_t;
+
+extern const LoRa_transport_t LoRa_sim_transport;
+
+// Chip recém-saído do reset com os valores padrão do datasheet
+void LoRa_sim_init(LoRa_sim_t *sim, uint32_t spi_frequency);
+void LoRa_sim_reset_counters(LoRa_sim_t *sim);
+
+// Coloca um pacote na FIFO como se tivesse sido recebido e sinaliza RxDone
+void LoRa_sim_inject_rx(LoRa_sim_t *sim, const uint8_t *data, size_t size, int8_t snr_q4, uint8_t rssi);
+
+// Último pacote transmitido (FIFO a partir de REG_FIFO_TX_BASE_ADDR no TX)
+size_t LoRa_sim_last_tx(LoRa_sim_t *sim, uint8_t *data, size_t size);
+
+#endif
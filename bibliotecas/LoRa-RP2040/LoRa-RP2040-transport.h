@@ -0,0 +1,20 @@
+#ifndef LORA_RP2040_TRANSPORT_H
+#define LORA_RP2040_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Barramento do rádio, separado do driver para trocar o SPI por outro
+// (por exemplo o modelo de LoRa-RP2040-sim.c). O resto do driver (GPIO,
+// alarmes, DMA, PIO, multicore) continua usando o Pico SDK; nos testes em
+// host ele é compilado contra o SDK simulado de testes/host-sdk.
+// As rajadas controlam o próprio CS; o endereço chega sem o bit de escrita.
+// delay_us e time_us substituem sleep_us/time_us_64.
+typedef struct {
+    void (*write_burst)(void *context, uint8_t address, const uint8_t *buffer, size_t size);
+    void (*read_burst)(void *context, uint8_t address, uint8_t *buffer, size_t size);
+    void (*delay_us)(void *context, uint32_t us);
+    uint64_t (*time_us)(void *context);
+} LoRa_transport_t;
+
+#endif
@@ -4,6 +4,13 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "sx127x_spi.pio.h"
 
 // registers
 #define REG_FIFO                 0x00
@@ -22,6 +29,7 @@
 #define REG_FIFO_RX_CURRENT_ADDR 0x10
 #define REG_IRQ_FLAGS            0x12
 #define REG_RX_NB_BYTES          0x13
+#define REG_MODEM_STAT           0x18
 #define REG_PKT_SNR_VALUE        0x19
 #define REG_PKT_RSSI_VALUE       0x1a
 #define REG_RSSI_VALUE           0x1b
@@ -66,401 +74,2296 @@
 
 #define MAX_PKT_LENGTH           255
 
+// RegModemStat: sinal detectado / cabeçalho válido
+#define MODEM_STAT_SIGNAL_MASK   0x0b
+
+// Consumo típico do SX1276 (datasheet, tabela 6), usado nas estimativas de RX
+// com ciclo de trabalho. Sleep -> RX passa pelo standby por ~250 us.
+#define CURRENT_RX_UA            11500.0f
+#define CURRENT_SLEEP_UA         0.2f
+#define CURRENT_STDBY_UA         1600.0f
+#define WAKEUP_US                250
+
+// SCK máximo do SX127x (datasheet, tabela 11) e passo da calibração
+#define SPI_MAX_FREQUENCY        10000000
+#define SPI_CALIBRATION_STEP     1000000
+#define SPI_CALIBRATION_ROUNDS   16
+
+// Fila de eventos do DIO0 (potência de 2)
+#ifndef LORA_EVENT_RING_SIZE
+#define LORA_EVENT_RING_SIZE     8
+#endif
+
+// Cópia local (shadow) dos registradores de configuração
+#define SHADOW_SIZE              (REG_PA_DAC + 1)
+
 #if (ESP8266 || ESP32)
 #define ISR_PREFIX ICACHE_RAM_ATTR
 #else
 #define ISR_PREFIX
 #endif
-// Estrutura para substituir a classe LoRaClass
+
+// Larguras de banda indexadas pelo campo Bw de REG_MODEM_CONFIG_1
+static const long bw_table[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+
+// Tempo de símbolo 2^SF / BW em µs com 8 bits de fração, calculado pelo
+// compilador para SF6..SF12 x bw_table (nenhuma divisão em tempo de execução)
+#define SYMBOL_TIME_Q8(sf, bw)   ((uint32_t)(((1ull << (sf)) * 256000000ull + (bw) / 2) / (bw)))
+#define SYMBOL_TIME_ROW(sf) { \
+    SYMBOL_TIME_Q8(sf, 7800),  SYMBOL_TIME_Q8(sf, 10400), SYMBOL_TIME_Q8(sf, 15600), \
+    SYMBOL_TIME_Q8(sf, 20800), SYMBOL_TIME_Q8(sf, 31250), SYMBOL_TIME_Q8(sf, 41700), \
+    SYMBOL_TIME_Q8(sf, 62500), SYMBOL_TIME_Q8(sf, 125000), SYMBOL_TIME_Q8(sf, 250000), \
+    SYMBOL_TIME_Q8(sf, 500000) }
+
+static const uint32_t symbol_time_q8[7][10] = {
+    SYMBOL_TIME_ROW(6), SYMBOL_TIME_ROW(7), SYMBOL_TIME_ROW(8), SYMBOL_TIME_ROW(9),
+    SYMBOL_TIME_ROW(10), SYMBOL_TIME_ROW(11), SYMBOL_TIME_ROW(12)
+};
+
+// ceil(x / d) = (x + d - 1) * ceil(2^20 / d) >> 20, exato para os blocos de
+// 4 * (SF - 2 * LDO) bits (d = 16..48) e x até 32735 bits (test_lora_toa);
+// o payload máximo tem 2060
+#define BLOCK_RECIPROCAL(d)      ((uint32_t)(((1u << 20) + (d) - 1) / (d)))
+
+static const uint32_t block_reciprocal[13] = {
+    0, 0, 0, 0, BLOCK_RECIPROCAL(16), BLOCK_RECIPROCAL(20), BLOCK_RECIPROCAL(24),
+    BLOCK_RECIPROCAL(28), BLOCK_RECIPROCAL(32), BLOCK_RECIPROCAL(36), BLOCK_RECIPROCAL(40),
+    BLOCK_RECIPROCAL(44), BLOCK_RECIPROCAL(48)
+};
+
+// Símbolo acima de 16 ms exige LowDataRateOptimize
+#define LDO_SYMBOL_Q8            (16000u * 256u)
+
+// Borda do DIO0 registrada pela IRQ e tratada em LoRa_poll_events. Com a
+// fila de RX ativa a IRQ já leu e limpou as flags (has_flags) e copiou o
+// quadro; length e fifo_address descrevem esse quadro.
 typedef struct {
+    uint64_t timestamp_us;
+    bool has_flags;
+    uint8_t irq_flags;
+    uint8_t length;
+    uint8_t fifo_address;
+} dio0_event_t;
+
+// Estrutura para substituir a classe LoRaClass (um rádio por instância)
+struct LoRa_s {
     spi_inst_t* spi;
+    uint miso;
+    uint sck;
+    uint mosi;
     int ss;
     int reset;
     int dio0;
+    uint32_t spi_frequency;
+    // Transporte do barramento; o padrão é rp2040_transport (SPI/PIO/DMA)
+    const LoRa_transport_t *transport;
+    void *transport_context;
+    // Backend PIO (NULL = bloco SPI de hardware)
+    PIO pio;
+    uint pio_sm;
     long frequency;
     int packet_index;
+    int packet_length;       // tamanho do pacote recebido, latched no RxDone
+    int payload_length;      // bytes já escritos na FIFO do pacote em montagem
     int implicit_header_mode;
-    void (*on_receive)(int);
-    void (*on_cad_done)(bool);
-    void (*on_tx_done)(void);
-} LoRa;
-
-// Instância global (substitui o singleton original)
-static LoRa lora_instance;
+    void (*on_receive)(LoRa_t *lora, int size);
+    void (*on_cad_done)(LoRa_t *lora, bool detected);
+    void (*on_tx_done)(LoRa_t *lora);
+    volatile bool tx_wait;   // LoRa_end_packet(false) aguardando o TxDone
+    volatile bool tx_edge;
+    volatile uint64_t tx_edge_us;
+    // Instantes (time_us_64) do fim de cada pacote e o seu tempo no ar
+    uint64_t rx_done_us;
+    uint64_t tx_done_us;
+    uint32_t rx_airtime_us;
+    uint32_t tx_airtime_us;
+    volatile bool tx_scheduled;  // TX agendado por LoRa_schedule_tx ainda não disparado
+    alarm_id_t tx_alarm;         // id do alarme (0 = desconhecido ou já disparado)
+    volatile bool cad_active;    // CAD avulso (LoRa_channel_activity_detection) em curso
+    // Fila lock-free produtor único (IRQ) / consumidor único (LoRa_poll_events)
+    struct {
+        dio0_event_t slots[LORA_EVENT_RING_SIZE];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        volatile uint32_t dropped;
+    } events;
+    // Fila de quadros recebidos: produtor a IRQ de software do DIO0
+    // (rx_queue_capture), consumidor LoRa_rx_pop
+    struct {
+        bool enabled;
+        LoRa_rx_frame_t slots[LORA_RX_QUEUE_SLOTS];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        volatile uint32_t overflows;
+    } rx_queue;
+    // Fila de TX em sequência: o TxDone recarrega a FIFO na IRQ de software
+    struct {
+        struct {
+            uint8_t data[255];
+            uint8_t length;
+        } slots[LORA_TX_QUEUE_SLOTS];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        volatile bool active;     // rajada em andamento, DIO0 = TxDone
+        uint32_t airtime_us;      // tempo no ar do quadro em transmissão
+        uint32_t packets;
+        uint64_t first_start_us;
+        uint64_t last_start_us;
+        uint64_t last_done_us;
+        uint64_t airtime_sum_us;
+        uint64_t gap_sum_us;
+        uint32_t gap_max_us;
+    } tx_queue;
+    // Borda do DIO0 com a fila de TX ou de RX ativa: o SPI fica para a IRQ
+    // de software (deferred_irq_handler), não para a IRQ do GPIO
+    struct {
+        volatile bool pending;
+        uint8_t core;                 // núcleo cuja IRQ de software foi pendurada
+        uint64_t edge_us;
+    } deferred;
+    // Listen-before-talk sobre a fila de TX: CAD antes de cada quadro
+    struct {
+        bool enabled;
+        volatile bool cad_pending;    // DIO0 = CadDone, resultado ainda não lido
+        volatile bool backoff;        // alarme de backoff armado e ainda não disparado
+        uint32_t slot_us;             // unidade do backoff
+        uint8_t max_attempts;
+        uint8_t attempts;             // CADs ocupados do quadro atual
+        uint32_t rng;                 // xorshift32
+        alarm_id_t alarm;             // id do backoff (0 = desconhecido ou já disparado)
+        LoRa_lbt_stats_t stats;
+    } lbt;
+    // AFC: desvio médio (EWMA) de frequência de cada par, em Q16 (Hz/65536)
+    struct {
+        bool enabled;
+        uint8_t shift;                // peso da EWMA = 1 / 2^shift
+        uint32_t clock;               // ordem de uso, para substituir o mais antigo
+        struct {
+            uint32_t peer;
+            int64_t offset_q16;
+            uint32_t last_used;
+            uint16_t samples;
+        } peers[LORA_AFC_PEERS];
+    } afc;
+    // RX com ciclo de trabalho: um alarme alterna janelas de RX e sleep
+    struct {
+        volatile bool active;
+        bool listening;
+        uint32_t rx_us;
+        uint32_t sleep_us;
+        alarm_id_t alarm;
+        uint32_t windows;
+        uint32_t extended;            // janelas estendidas por sinal em curso
+    } sniff;
+    // Serviço no core1: o core0 enfileira TX aqui e avisa pela FIFO entre núcleos
+    struct {
+        bool enabled;
+        struct {
+            uint8_t data[255];
+            uint8_t length;
+            uint64_t queued_us;
+        } slots[LORA_SERVICE_TX_SLOTS];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        LoRa_service_stats_t stats;
+    } service;
+    uint8_t shadow[SHADOW_SIZE];
+    uint32_t shadow_valid[(SHADOW_SIZE + 31) / 32];
+    // Arbitragem do SPI entre o laço principal, as IRQs e os dois núcleos
+    struct {
+        spin_lock_t *lock;
+        volatile int8_t owner;   // núcleo que detém o lock (-1 = livre)
+        uint8_t depth;           // reentrância no mesmo núcleo
+    } bus;
+    // Transporte por DMA para as rajadas da FIFO (opcional)
+    struct {
+        int tx_channel;          // -1 quando o DMA não está em uso
+        int rx_channel;
+        volatile bool busy;      // rajada em andamento, CS ainda em nível baixo
+        bool pending_tx;         // LoRa_end_packet adiado até o fim da rajada
+        bool pending_tx_async;
+        uint8_t dummy;           // fonte/destino dos bytes descartados
+        void (*on_done)(LoRa_t *lora);
+    } dma;
+};
+
+// Instâncias (substituem o singleton original), uma por módulo SX127x
+static LoRa_t lora_instances[LORA_MAX_INSTANCES];
+static int lora_instance_count;
+
+// Despacho da IRQ: instância dona de cada pino DIO0
+static LoRa_t *dio0_owner[NUM_BANK0_GPIOS];
+
+// Usuários do handler compartilhado em DMA_IRQ_0
+static int dma_irq_users;
+
+// IRQ de software de prioridade mínima, por núcleo (-1 = não reservada)
+static int deferred_irq[2] = {-1, -1};
+
+// Offset do programa sx127x_spi em cada PIO (-1 = ainda não carregado)
+static int pio_program_offset[2] = {-1, -1};
+
+// Instância atendida pelo core1 (só existe um core1)
+static LoRa_t *service_lora;
+
+// Comandos do core0 para o core1 pela FIFO entre núcleos
+#define SERVICE_CMD_TX             1
+#define SERVICE_CMD_RECEIVE        2
+#define SERVICE_CMD_IDLE           3
+#define SERVICE_CMD_SLEEP          4
 
 // Protótipos de funções internas
-static uint8_t read_register(uint8_t address);
-static void write_register(uint8_t address, uint8_t value);
-static uint8_t single_transfer(uint8_t address, uint8_t value);
-static void handle_dio0_rise(void);
+static uint8_t read_register(LoRa_t *lora, uint8_t address);
+static void write_register(LoRa_t *lora, uint8_t address, uint8_t value);
+static uint8_t single_transfer(LoRa_t *lora, uint8_t address, uint8_t value);
+static uint32_t bus_lock(LoRa_t *lora);
+static void bus_unlock(LoRa_t *lora, uint32_t status);
+static void write_burst(LoRa_t *lora, uint8_t address, const uint8_t *buffer, size_t size);
+static void read_burst(LoRa_t *lora, uint8_t address, uint8_t *buffer, size_t size);
+static uint64_t now_us(LoRa_t *lora);
+static void rp2040_write_burst(void *context, uint8_t address, const uint8_t *buffer, size_t size);
+static void rp2040_read_burst(void *context, uint8_t address, uint8_t *buffer, size_t size);
+static void rp2040_delay_us(void *context, uint32_t us);
+static uint64_t rp2040_time_us(void *context);
+static bool pio_backend_init(LoRa_t *lora);
+static uint32_t link_set_rate(LoRa_t *lora, uint32_t frequency);
+static void pio_transfer(LoRa_t *lora, uint8_t address, const uint8_t *tx, uint8_t *rx, size_t size);
+static void handle_dio0_rise(LoRa_t *lora, const dio0_event_t *event);
+static void rx_queue_push(LoRa_t *lora, uint8_t irq_flags, uint8_t fifo_address, int length, uint64_t timestamp_us);
+static void rx_queue_capture(LoRa_t *lora, dio0_event_t *event);
+static long frequency_error_hz(LoRa_t *lora);
+static bool shadow_cacheable(uint8_t address);
+static void LoRa_set_ldo_flag(LoRa_t *lora);
+static void LoRa_set_ocp(LoRa_t *lora, uint8_t ma);
+static uint8_t ocp_register(uint8_t ma);
+static void tx_power_registers(int level, uint8_t *pa_dac, uint8_t *ocp, uint8_t *pa_config);
+static uint32_t frequency_to_frf(long frequency);
+static int bandwidth_index(long sbw);
+static bool ldo_required(long bw, int sf);
+static void write_registers(LoRa_t *lora, uint8_t address, const uint8_t *values, size_t size);
+static void start_tx(LoRa_t *lora, bool async);
+static bool wait_tx_done(LoRa_t *lora);
+static uint32_t time_on_air_us(LoRa_t *lora, int payload_length);
+static uint32_t symbol_time(LoRa_t *lora);
+static void gpio_callback(uint gpio, uint32_t events);
+static int64_t scheduled_tx_callback(alarm_id_t id, void *user_data);
+static bool dio0_irq_needed(LoRa_t *lora);
+static void tx_queue_load(LoRa_t *lora);
+static void tx_queue_done(LoRa_t *lora, uint64_t now);
+static void tx_queue_next(LoRa_t *lora);
+static void lbt_start_cad(LoRa_t *lora);
+static void lbt_cad_done(LoRa_t *lora, uint8_t irq_flags);
+static int64_t lbt_backoff_callback(alarm_id_t id, void *user_data);
+static int64_t sniff_callback(alarm_id_t id, void *user_data);
+static bool rx_unread(LoRa_t *lora);
+static void service_main(void);
+static void service_command(LoRa_t *lora, uint32_t command);
+static void dma_wait(LoRa_t *lora);
+static void dma_complete(LoRa_t *lora);
+static void deferred_irq_init(void);
+static void deferred_irq_handler(void);
+static void deferred_run(LoRa_t *lora);
+static void events_push(LoRa_t *lora, const dio0_event_t *event);
+static void dma_irq_handler(void);
+static void dma_start(LoRa_t *lora, const volatile void *src, bool src_incr, volatile void *dst, bool dst_incr, size_t size);
+
+// Transporte padrão: periféricos do RP2040
+static const LoRa_transport_t rp2040_transport = {
+    rp2040_write_burst,
+    rp2040_read_burst,
+    rp2040_delay_us,
+    rp2040_time_us,
+};
 
 // Implementações
 
-void LoRa_init(void) {
-    lora_instance.spi = spi0;
-    lora_instance.ss = LORA_DEFAULT_SS_PIN;
-    lora_instance.reset = LORA_DEFAULT_RESET_PIN;
-    lora_instance.dio0 = LORA_DEFAULT_DIO0_PIN;
-    lora_instance.frequency = 0;
-    lora_instance.packet_index = 0;
-    lora_instance.implicit_header_mode = 0;
-    lora_instance.on_receive = NULL;
-    lora_instance.on_cad_done = NULL;
-    lora_instance.on_tx_done = NULL;
-}
-
-int LoRa_begin(long frequency) {
-    // Configuração inicial dos pinos
-    gpio_init(lora_instance.ss);
-    gpio_set_dir(lora_instance.ss, GPIO_OUT);
-    gpio_put(lora_instance.ss, 1);
-
-    if (lora_instance.reset != -1) {
-        gpio_init(lora_instance.reset);
-        gpio_set_dir(lora_instance.reset, GPIO_OUT);
-        gpio_put(lora_instance.reset, 0);
-        sleep_ms(10);
-        gpio_put(lora_instance.reset, 1);
-        sleep_ms(10);
+LoRa_t *LoRa_init(void) {
+    if (lora_instance_count == LORA_MAX_INSTANCES) return NULL;
+    LoRa_t *lora = &lora_instances[lora_instance_count++];
+
+    lora->spi = LORA_DEFAULT_SPI;
+    lora->miso = PIN_MISO;
+    lora->sck = PIN_SCK;
+    lora->mosi = PIN_MOSI;
+    lora->ss = LORA_DEFAULT_SS_PIN;
+    lora->reset = LORA_DEFAULT_RESET_PIN;
+    lora->dio0 = LORA_DEFAULT_DIO0_PIN;
+    lora->spi_frequency = LORA_DEFAULT_SPI_FREQUENCY;
+    lora->transport = &rp2040_transport;
+    lora->transport_context = lora;
+    lora->pio = NULL;
+    lora->pio_sm = 0;
+    lora->frequency = 0;
+    lora->packet_index = 0;
+    lora->packet_length = 0;
+    lora->payload_length = 0;
+    lora->implicit_header_mode = 0;
+    lora->on_receive = NULL;
+    lora->on_cad_done = NULL;
+    lora->on_tx_done = NULL;
+    lora->tx_wait = false;
+    lora->tx_edge = false;
+    lora->tx_edge_us = 0;
+    lora->rx_done_us = 0;
+    lora->tx_done_us = 0;
+    lora->rx_airtime_us = 0;
+    lora->tx_airtime_us = 0;
+    lora->tx_scheduled = false;
+    lora->tx_alarm = 0;
+    lora->cad_active = false;
+    lora->events.head = 0;
+    lora->events.tail = 0;
+    lora->events.dropped = 0;
+    lora->rx_queue.enabled = false;
+    lora->rx_queue.head = 0;
+    lora->rx_queue.tail = 0;
+    lora->rx_queue.overflows = 0;
+    memset(&lora->tx_queue, 0, sizeof(lora->tx_queue));
+    memset(&lora->lbt, 0, sizeof(lora->lbt));
+    memset(&lora->afc, 0, sizeof(lora->afc));
+    memset(&lora->sniff, 0, sizeof(lora->sniff));
+    lora->service.enabled = false;
+    lora->service.head = 0;
+    lora->service.tail = 0;
+    memset(&lora->service.stats, 0, sizeof(lora->service.stats));
+    lora->dma.tx_channel = -1;
+    lora->dma.rx_channel = -1;
+    lora->dma.busy = false;
+    lora->dma.pending_tx = false;
+    lora->dma.pending_tx_async = false;
+    lora->dma.on_done = NULL;
+    lora->bus.lock = spin_lock_instance(spin_lock_claim_unused(true));
+    lora->bus.owner = -1;
+    lora->bus.depth = 0;
+    LoRa_invalidate_shadow(lora);
+    return lora;
+}
+
+void LoRa_set_pins(LoRa_t *lora, int ss, int reset, int dio0) {
+    lora->ss = ss;
+    lora->reset = reset;
+    lora->dio0 = dio0;
+}
+
+void LoRa_set_spi(LoRa_t *lora, spi_inst_t *spi, uint miso, uint sck, uint mosi) {
+    lora->spi = spi;
+    lora->miso = miso;
+    lora->sck = sck;
+    lora->mosi = mosi;
+}
+
+// Troca o bloco SPI por uma state machine do PIO, que também controla o CS.
+// Chamar antes de LoRa_begin; o SPI de hardware fica livre para outros usos.
+void LoRa_set_pio(LoRa_t *lora, PIO pio, uint miso, uint sck, uint mosi) {
+    lora->pio = pio;
+    lora->miso = miso;
+    lora->sck = sck;
+    lora->mosi = mosi;
+}
+
+// Substitui o barramento (por exemplo pelo modelo em LoRa-RP2040-sim.c).
+// Chamar antes de LoRa_begin; NULL volta ao transporte do RP2040.
+void LoRa_set_transport(LoRa_t *lora, const LoRa_transport_t *transport, void *context) {
+    lora->transport = transport ? transport : &rp2040_transport;
+    lora->transport_context = transport ? context : lora;
+}
+
+// Clock usado por LoRa_begin; chamar antes dele
+void LoRa_set_spi_frequency(LoRa_t *lora, uint32_t frequency) {
+    lora->spi_frequency = frequency;
+}
+
+uint32_t LoRa_get_spi_frequency(LoRa_t *lora) {
+    return lora->spi_frequency;
+}
+
+int LoRa_begin(LoRa_t *lora, long frequency) {
+    bool hardware = lora->transport == &rp2040_transport;
+
+    // O DIO0 indexa dio0_owner: pino do banco 0 e de uma instância só
+    if (lora->dio0 < 0 || lora->dio0 >= NUM_BANK0_GPIOS) return 0;
+    if (dio0_owner[lora->dio0] && dio0_owner[lora->dio0] != lora) return 0;
+
+    // Configuração inicial dos pinos (com PIO o CS é da state machine)
+    if (hardware && !lora->pio) {
+        gpio_init(lora->ss);
+        gpio_set_dir(lora->ss, GPIO_OUT);
+        gpio_put(lora->ss, 1);
+    }
+
+    if (hardware && lora->reset != -1) {
+        gpio_init(lora->reset);
+        gpio_set_dir(lora->reset, GPIO_OUT);
+        gpio_put(lora->reset, 0);
+        lora->transport->delay_us(lora->transport_context, 10000);
+        gpio_put(lora->reset, 1);
+        lora->transport->delay_us(lora->transport_context, 10000);
     }
 
+    // Após o reset o chip volta aos valores padrão
+    LoRa_invalidate_shadow(lora);
+
     // Inicialização do SPI
-    spi_init(spi0, 12500 * 1000); // Ajuste conforme necessário
-    gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
-    gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
-    gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
+    if (!hardware) {
+        // Barramento externo: nada a configurar aqui
+    } else if (lora->pio) {
+        if (!pio_backend_init(lora)) return 0;
+    } else {
+        lora->spi_frequency = spi_init(lora->spi, lora->spi_frequency);
+        gpio_set_function(lora->miso, GPIO_FUNC_SPI);
+        gpio_set_function(lora->sck, GPIO_FUNC_SPI);
+        gpio_set_function(lora->mosi, GPIO_FUNC_SPI);
+    }
+
+    // Um novo LoRa_begin com outro pino libera o anterior
+    for (int gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (dio0_owner[gpio] == lora) dio0_owner[gpio] = NULL;
+    }
+    dio0_owner[lora->dio0] = lora;
+    deferred_irq_init();
 
     // Verificação de versão
-    uint8_t version = read_register(REG_VERSION);
+    uint8_t version = read_register(lora, REG_VERSION);
     if (version != 0x12) return 0;
 
     // Configurações iniciais (similar ao original)
-    LoRa_sleep();
-    LoRa_set_frequency(frequency);
-    write_register(REG_FIFO_TX_BASE_ADDR, 0);
-    write_register(REG_FIFO_RX_BASE_ADDR, 0);
-    write_register(REG_LNA, read_register(REG_LNA) | 0x03);
-    write_register(REG_MODEM_CONFIG_3, 0x04);
-    LoRa_set_tx_power(17);
-    LoRa_idle();
+    LoRa_sleep(lora);
+    LoRa_set_frequency(lora, frequency);
+    write_register(lora, REG_FIFO_TX_BASE_ADDR, 0);
+    write_register(lora, REG_FIFO_RX_BASE_ADDR, 0);
+    write_register(lora, REG_LNA, read_register(lora, REG_LNA) | 0x03);
+    write_register(lora, REG_MODEM_CONFIG_3, 0x04);
+    LoRa_set_tx_power(lora, 17);
+    LoRa_idle(lora);
+
+    if (lora->service.enabled) {
+        // A partir daqui o SPI e o DIO0 pertencem ao core1
+        if (service_lora) return 0;
+        service_lora = lora;
+        // A IRQ do DIO0 é por núcleo: armada aqui (on_receive, fila de RX)
+        // ela seguiria ativa no core0 e o anel de eventos teria dois
+        // produtores. Só o core1 fica com ela.
+        gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, false);
+        lora->rx_queue.enabled = true;
+        multicore_launch_core1(service_main);
+    }
     
     return 1;
 }
 
+// Desfaz LoRa_begin: para a fila de TX (e o LBT), o TX agendado e o RX com
+// ciclo de trabalho, desarma o DIO0 e põe o rádio em sleep, sem deixar
+// alarme armado para esta instância. O rádio do modo de serviço pertence ao
+// core1 e não é encerrado aqui.
+void LoRa_end(LoRa_t *lora) {
+    if (lora == service_lora) return;
+
+    LoRa_tx_queue_flush(lora);
+    LoRa_cancel_scheduled_tx(lora);
+    LoRa_stop_duty_cycled(lora);
+    LoRa_disable_dma(lora);
+
+    lora->cad_active = false;
+    LoRa_sleep(lora);
+    if (lora->dio0 >= 0 && lora->dio0 < NUM_BANK0_GPIOS && dio0_owner[lora->dio0] == lora) {
+        gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, false);
+        dio0_owner[lora->dio0] = NULL;
+    }
+}
+
 // Continuação das implementações...
 
-int LoRa_begin_packet(int implicit_header) {
-    if (LoRa_is_transmitting()) return 0;
+int LoRa_begin_packet(LoRa_t *lora, int implicit_header) {
+    if (LoRa_is_transmitting(lora)) return 0;
 
-    LoRa_idle();
+    LoRa_idle(lora);
 
     if (implicit_header) {
-        LoRa_implicit_header_mode();
+        LoRa_implicit_header_mode(lora);
     } else {
-        LoRa_explicit_header_mode();
+        LoRa_explicit_header_mode(lora);
     }
 
-    write_register(REG_FIFO_ADDR_PTR, 0);
-    write_register(REG_PAYLOAD_LENGTH, 0);
+    write_register(lora, REG_FIFO_ADDR_PTR, 0);
+    write_register(lora, REG_PAYLOAD_LENGTH, 0);
+    lora->payload_length = 0;
     return 1;
 }
 
-int LoRa_end_packet(bool async) {
-    if (async && lora_instance.on_tx_done) {
-        write_register(REG_DIO_MAPPING_1, 0x40);
+int LoRa_end_packet(LoRa_t *lora, bool async) {
+    if (async && lora->dma.busy) {
+        // A FIFO ainda está sendo carregada: o TX é disparado pela IRQ do DMA
+        lora->dma.pending_tx_async = true;
+        lora->dma.pending_tx = true;
+        return 1;
     }
 
-    write_register(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_TX);
+    if (async) {
+        start_tx(lora, true);
+        return 1;
+    }
+
+    // Modo bloqueante: DIO0 = TxDone e o núcleo dorme em WFE até a borda
+    lora->tx_edge = false;
+    lora->tx_wait = true;
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+
+    start_tx(lora, false);
+    bool done = wait_tx_done(lora);
 
-    if (!async) {
-        while ((read_register(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) == 0) {
-            sleep_ms(0);
+    lora->tx_wait = false;
+    gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+    return done ? 1 : 0;
+}
+
+static bool wait_tx_done(LoRa_t *lora) {
+    // Tempo no ar com 25% de folga mais 10 ms para a rampa do PA
+    uint32_t toa = time_on_air_us(lora, lora->payload_length);
+    absolute_time_t deadline = make_timeout_time_us((uint64_t)toa + toa / 4 + 10000);
+
+    while (!lora->tx_edge) {
+        if (best_effort_wfe_or_timeout(deadline)) break;
+    }
+
+    // Uma única leitura confirma o TxDone (ou cobre uma borda perdida)
+    uint8_t irq_flags = read_register(lora, REG_IRQ_FLAGS);
+    if (!(irq_flags & IRQ_TX_DONE_MASK)) return false;
+    write_register(lora, REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);
+
+    lora->tx_done_us = lora->tx_edge ? lora->tx_edge_us : now_us(lora);
+    lora->tx_airtime_us = toa;
+    return true;
+}
+
+// Símbolo da configuração atual em µs Q8; SF e BW saem da shadow
+static uint32_t symbol_time(LoRa_t *lora) {
+    int sf = LoRa_get_spreading_factor(lora);
+    int bw = read_register(lora, REG_MODEM_CONFIG_1) >> 4;
+    if (sf < 6) sf = 6;
+    if (sf > 12) sf = 12;
+    if (bw > 9) bw = 9;
+    return symbol_time_q8[sf - 6][bw];
+}
+
+// Tempo no ar (AN1200.13) para a configuração atual do modem. SF6 usa a
+// mesma fórmula, como no datasheet do SX1276; o ajuste de SF5/SF6 do
+// SX1276GetTimeOnAir do LoRaMac-node (preâmbulo >= 12, +2 símbolos) é do SX126x.
+static uint32_t time_on_air_us(LoRa_t *lora, int payload_length) {
+    uint32_t symbol = symbol_time(lora);
+    int sf = LoRa_get_spreading_factor(lora);
+    if (sf < 6) sf = 6;
+    if (sf > 12) sf = 12;
+    uint8_t config1 = read_register(lora, REG_MODEM_CONFIG_1);
+    int cr = (config1 >> 1) & 0x07;
+    bool implicit_header = config1 & 0x01;
+    bool crc = read_register(lora, REG_MODEM_CONFIG_2) & 0x04;
+    long preamble = (read_register(lora, REG_PREAMBLE_MSB) << 8) | read_register(lora, REG_PREAMBLE_LSB);
+    int block = sf - (symbol > LDO_SYMBOL_Q8 ? 2 : 0);
+
+    int32_t bits = 8 * payload_length - 4 * sf + 28 + (crc ? 16 : 0) - (implicit_header ? 20 : 0);
+    uint32_t payload_symbols = 8;
+    if (bits > 0) {
+        uint32_t blocks = ((uint32_t)bits + 4 * block - 1) * block_reciprocal[block] >> 20;
+        payload_symbols += blocks * (cr + 4);
+    }
+
+    // Em quartos de símbolo para cobrir os 4,25 símbolos do preâmbulo.
+    // Satura: SF12 a 7,8 kHz com preâmbulo longo passa de 2^32 µs.
+    uint64_t quarter_symbols = 4 * (preamble + payload_symbols) + 17;
+    uint64_t toa = (quarter_symbols * symbol) >> 10;
+    return toa > UINT32_MAX ? UINT32_MAX : (uint32_t)toa;
+}
+
+static void start_tx(LoRa_t *lora, bool async) {
+    write_register(lora, REG_PAYLOAD_LENGTH, lora->payload_length);
+
+    if (!async || lora->on_tx_done || lora->tx_queue.active) {
+        write_register(lora, REG_DIO_MAPPING_1, 0x40);
+    }
+
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_TX);
+
+    if (lora->tx_queue.active) {
+        // Intervalo entre o TxDone anterior e este TX
+        uint64_t now = now_us(lora);
+        if (lora->tx_queue.packets > 0) {
+            uint32_t gap = now - lora->tx_queue.last_done_us;
+            lora->tx_queue.gap_sum_us += gap;
+            if (gap > lora->tx_queue.gap_max_us) lora->tx_queue.gap_max_us = gap;
         }
-        write_register(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);
+        lora->tx_queue.last_start_us = now;
     }
-    return 1;
 }
 
-bool LoRa_is_transmitting(void) {
-    if ((read_register(REG_OP_MODE) & MODE_TX) == MODE_TX) return true;
+bool LoRa_is_transmitting(LoRa_t *lora) {
+    if ((read_register(lora, REG_OP_MODE) & MODE_TX) == MODE_TX) return true;
     
-    if (read_register(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) {
-        write_register(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);
+    if (read_register(lora, REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK) {
+        write_register(lora, REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);
     }
     return false;
 }
 
-int LoRa_parse_packet(int size) {
+int LoRa_parse_packet(LoRa_t *lora, int size) {
     int packet_length = 0;
-    uint8_t irq_flags = read_register(REG_IRQ_FLAGS);
+    uint8_t irq_flags = read_register(lora, REG_IRQ_FLAGS);
 
     if (size > 0) {
-        LoRa_implicit_header_mode();
-        write_register(REG_PAYLOAD_LENGTH, size & 0xff);
+        LoRa_implicit_header_mode(lora);
+        write_register(lora, REG_PAYLOAD_LENGTH, size & 0xff);
     } else {
-        LoRa_explicit_header_mode();
+        LoRa_explicit_header_mode(lora);
     }
 
-    write_register(REG_IRQ_FLAGS, irq_flags);
+    write_register(lora, REG_IRQ_FLAGS, irq_flags);
 
     if ((irq_flags & IRQ_RX_DONE_MASK) && !(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
-        lora_instance.packet_index = 0;
-        packet_length = lora_instance.implicit_header_mode ? 
-            read_register(REG_PAYLOAD_LENGTH) : 
-            read_register(REG_RX_NB_BYTES);
+        lora->packet_index = 0;
+        packet_length = lora->implicit_header_mode ? 
+            read_register(lora, REG_PAYLOAD_LENGTH) : 
+            read_register(lora, REG_RX_NB_BYTES);
+        lora->packet_length = packet_length;
         
-        write_register(REG_FIFO_ADDR_PTR, read_register(REG_FIFO_RX_CURRENT_ADDR));
-        LoRa_idle();
-    } else if (read_register(REG_OP_MODE) != (MODE_LONG_RANGE_MODE | MODE_RX_SINGLE)) {
-        write_register(REG_FIFO_ADDR_PTR, 0);
-        write_register(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_SINGLE);
+        write_register(lora, REG_FIFO_ADDR_PTR, read_register(lora, REG_FIFO_RX_CURRENT_ADDR));
+        LoRa_idle(lora);
+    } else if (read_register(lora, REG_OP_MODE) != (MODE_LONG_RANGE_MODE | MODE_RX_SINGLE)) {
+        write_register(lora, REG_FIFO_ADDR_PTR, 0);
+        write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_SINGLE);
     }
     return packet_length;
 }
 
-int LoRa_packet_rssi(void) {
-    return read_register(REG_PKT_RSSI_VALUE) - 
-        (lora_instance.frequency < RF_MID_BAND_THRESHOLD ? 
+int LoRa_packet_rssi(LoRa_t *lora) {
+    return read_register(lora, REG_PKT_RSSI_VALUE) - 
+        (lora->frequency < RF_MID_BAND_THRESHOLD ? 
          RSSI_OFFSET_LF_PORT : RSSI_OFFSET_HF_PORT);
 }
 
-float LoRa_packet_snr(void) {
-    return ((int8_t)read_register(REG_PKT_SNR_VALUE)) * 0.25f;
+float LoRa_packet_snr(LoRa_t *lora) {
+    return ((int8_t)read_register(lora, REG_PKT_SNR_VALUE)) * 0.25f;
+}
+
+long LoRa_packet_frequency_error(LoRa_t *lora) {
+    return frequency_error_hz(lora);
 }
 
-size_t LoRa_write(const uint8_t *buffer, size_t size) {
-    int current_length = read_register(REG_PAYLOAD_LENGTH);
+size_t LoRa_write(LoRa_t *lora, const uint8_t *buffer, size_t size) {
+    int current_length = lora->payload_length;
     
     if ((current_length + size) > MAX_PKT_LENGTH) {
         size = MAX_PKT_LENGTH - current_length;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        write_register(REG_FIFO, buffer[i]);
-    }
+    // Uma única transação: CS, endereço da FIFO e o buffer inteiro
+    write_burst(lora, REG_FIFO, buffer, size);
 
-    write_register(REG_PAYLOAD_LENGTH, current_length + size);
+    // REG_PAYLOAD_LENGTH é escrito uma única vez em LoRa_end_packet
+    lora->payload_length = current_length + size;
     return size;
 }
 
-int LoRa_available(void) {
-    return read_register(REG_RX_NB_BYTES) - lora_instance.packet_index;
+int LoRa_available(LoRa_t *lora) {
+    return lora->packet_length - lora->packet_index;
 }
 
-int LoRa_read(void) {
-    if (!LoRa_available()) return -1;
-    lora_instance.packet_index++;
-    return read_register(REG_FIFO);
+int LoRa_read(LoRa_t *lora) {
+    if (LoRa_available(lora) <= 0) return -1;
+    // Lê antes de avançar: o RX com ciclo de trabalho só dorme com tudo lido
+    int value = read_register(lora, REG_FIFO);
+    lora->packet_index++;
+    return value;
 }
 
-void LoRa_receive(int size) {
-    write_register(REG_DIO_MAPPING_1, 0x00);
+size_t LoRa_read_buffer(LoRa_t *lora, uint8_t *dst, size_t len) {
+    int available = LoRa_available(lora);
+    if (available <= 0) return 0;
+    if (len > (size_t)available) len = available;
+
+    // Esvazia a FIFO numa única transação
+    read_burst(lora, REG_FIFO, dst, len);
+    lora->packet_index += len;
+    return len;
+}
+
+void LoRa_receive(LoRa_t *lora, int size) {
+    write_register(lora, REG_DIO_MAPPING_1, 0x00);
 
     if (size > 0) {
-        LoRa_implicit_header_mode();
-        write_register(REG_PAYLOAD_LENGTH, size & 0xff);
+        LoRa_implicit_header_mode(lora);
+        write_register(lora, REG_PAYLOAD_LENGTH, size & 0xff);
     } else {
-        LoRa_explicit_header_mode();
+        LoRa_explicit_header_mode(lora);
     }
-    write_register(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
 }
 
-void LoRa_idle(void) {
-    write_register(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_STDBY);
+void LoRa_idle(LoRa_t *lora) {
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_STDBY);
 }
 
-void LoRa_sleep(void) {
-    write_register(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_SLEEP);
+void LoRa_sleep(LoRa_t *lora) {
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_SLEEP);
+    // Em sleep a FIFO é apagada: não sobra pacote para ler
+    lora->packet_index = 0;
+    lora->packet_length = 0;
 }
 
-void LoRa_set_tx_power(int level) {
+void LoRa_set_tx_power(LoRa_t *lora, int level) {
+    uint8_t pa_dac, ocp, pa_config;
+    tx_power_registers(level, &pa_dac, &ocp, &pa_config);
+    write_register(lora, REG_PA_DAC, pa_dac);
+    write_register(lora, REG_OCP, ocp);
+    write_register(lora, REG_PA_CONFIG, pa_config);
+}
+
+static void tx_power_registers(int level, uint8_t *pa_dac, uint8_t *ocp, uint8_t *pa_config) {
     if (level > 17) {
         level = (level > 20) ? 20 : level;
         level -= 3;
-        write_register(REG_PA_DAC, 0x87);
-        LoRa_set_ocp(140);
+        *pa_dac = 0x87;
+        *ocp = ocp_register(140);
     } else {
         level = (level < 2) ? 2 : level;
-        write_register(REG_PA_DAC, 0x84);
-        LoRa_set_ocp(100);
+        *pa_dac = 0x84;
+        *ocp = ocp_register(100);
     }
-    write_register(REG_PA_CONFIG, PA_BOOST | (level - 2));
+    *pa_config = PA_BOOST | (level - 2);
+}
+
+static void LoRa_set_ocp(LoRa_t *lora, uint8_t ma) {
+    write_register(lora, REG_OCP, ocp_register(ma));
 }
 
-static void LoRa_set_ocp(uint8_t ma) {
+static uint8_t ocp_register(uint8_t ma) {
     uint8_t ocp = 27;
     if (ma <= 120) {
         ocp = (ma - 45) / 5;
     } else if (ma <= 240) {
         ocp = (ma + 30) / 10;
     }
-    write_register(REG_OCP, 0x20 | (ocp & 0x1F));
+    return 0x20 | (ocp & 0x1F);
 }
 
-void LoRa_set_sync_word(int sw) {
-    write_register(REG_SYNC_WORD, sw);
+void LoRa_set_sync_word(LoRa_t *lora, int sw) {
+    write_register(lora, REG_SYNC_WORD, sw);
 }
 
-void LoRa_enable_crc(void) {
-    write_register(REG_MODEM_CONFIG_2, read_register(REG_MODEM_CONFIG_2) | 0x04);
+void LoRa_enable_crc(LoRa_t *lora) {
+    write_register(lora, REG_MODEM_CONFIG_2, read_register(lora, REG_MODEM_CONFIG_2) | 0x04);
 }
 
-void LoRa_disable_crc(void) {
-    write_register(REG_MODEM_CONFIG_2, read_register(REG_MODEM_CONFIG_2) & ~0x04);
+void LoRa_disable_crc(LoRa_t *lora) {
+    write_register(lora, REG_MODEM_CONFIG_2, read_register(lora, REG_MODEM_CONFIG_2) & ~0x04);
 }
 
 // Continuação das funções de configuração do modem...
 
-void LoRa_set_spreading_factor(int sf) {
+void LoRa_set_spreading_factor(LoRa_t *lora, int sf) {
     if (sf < 6) sf = 6;
     else if (sf > 12) sf = 12;
 
     if (sf == 6) {
-        write_register(REG_DETECTION_OPTIMIZE, 0xc5);
-        write_register(REG_DETECTION_THRESHOLD, 0x0c);
+        write_register(lora, REG_DETECTION_OPTIMIZE, 0xc5);
+        write_register(lora, REG_DETECTION_THRESHOLD, 0x0c);
     } else {
-        write_register(REG_DETECTION_OPTIMIZE, 0xc3);
-        write_register(REG_DETECTION_THRESHOLD, 0x0a);
+        write_register(lora, REG_DETECTION_OPTIMIZE, 0xc3);
+        write_register(lora, REG_DETECTION_THRESHOLD, 0x0a);
     }
 
-    write_register(REG_MODEM_CONFIG_2, 
-        (read_register(REG_MODEM_CONFIG_2) & 0x0f) | ((sf << 4) & 0xf0));
+    write_register(lora, REG_MODEM_CONFIG_2, 
+        (read_register(lora, REG_MODEM_CONFIG_2) & 0x0f) | ((sf << 4) & 0xf0));
     
-    LoRa_set_ldo_flag();
+    LoRa_set_ldo_flag(lora);
 }
 
-static void LoRa_set_ldo_flag(void) {
-    long bw = LoRa_get_signal_bandwidth();
-    long symbol_duration = 1000 / (bw / (1L << LoRa_get_spreading_factor()));
-    
-    bool ldo_on = symbol_duration > 16;
-    uint8_t config3 = read_register(REG_MODEM_CONFIG_3);
+static void LoRa_set_ldo_flag(LoRa_t *lora) {
+    bool ldo_on = ldo_required(LoRa_get_signal_bandwidth(lora), LoRa_get_spreading_factor(lora));
+    uint8_t config3 = read_register(lora, REG_MODEM_CONFIG_3);
     
     config3 = ldo_on ? 
         (config3 | (1 << 3)) : 
         (config3 & ~(1 << 3));
     
-    write_register(REG_MODEM_CONFIG_3, config3);
+    write_register(lora, REG_MODEM_CONFIG_3, config3);
+}
+
+// Low Data Rate Optimize é obrigatório com símbolos acima de 16 ms
+static bool ldo_required(long bw, int sf) {
+    if (sf < 6) sf = 6;
+    if (sf > 12) sf = 12;
+    return symbol_time_q8[sf - 6][bandwidth_index(bw)] > LDO_SYMBOL_Q8;
 }
 
 // ... (demais funções de configuração seguindo o mesmo padrão)
 
-static void handle_dio0_rise(void) {
-    uint8_t irq_flags = read_register(REG_IRQ_FLAGS);
-    write_register(REG_IRQ_FLAGS, irq_flags); // Limpa flags
+static void handle_dio0_rise(LoRa_t *lora, const dio0_event_t *event) {
+    uint8_t irq_flags = event->irq_flags;
+    if (!event->has_flags) {
+        irq_flags = read_register(lora, REG_IRQ_FLAGS);
+        write_register(lora, REG_IRQ_FLAGS, irq_flags); // Limpa flags
+    }
 
     if (irq_flags & IRQ_CAD_DONE_MASK) {
-        if (lora_instance.on_cad_done) {
-            lora_instance.on_cad_done(irq_flags & IRQ_CAD_DETECTED_MASK);
+        if (lora->cad_active) {
+            // Fim do CAD avulso: o DIO0 volta ao estado de antes
+            lora->cad_active = false;
+            gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+        }
+        if (lora->on_cad_done) {
+            lora->on_cad_done(lora, irq_flags & IRQ_CAD_DETECTED_MASK);
         }
     } else if (!(irq_flags & IRQ_PAYLOAD_CRC_ERROR_MASK)) {
         if (irq_flags & IRQ_RX_DONE_MASK) {
-            lora_instance.packet_index = 0;
-            int packet_length = lora_instance.implicit_header_mode ? 
-                read_register(REG_PAYLOAD_LENGTH) : 
-                read_register(REG_RX_NB_BYTES);
-            write_register(REG_FIFO_ADDR_PTR, read_register(REG_FIFO_RX_CURRENT_ADDR));
-            if (lora_instance.on_receive) {
-                lora_instance.on_receive(packet_length);
+            int packet_length = event->length;
+            uint8_t fifo_address = event->fifo_address;
+            if (!event->has_flags) {
+                packet_length = lora->implicit_header_mode ?
+                    read_register(lora, REG_PAYLOAD_LENGTH) :
+                    read_register(lora, REG_RX_NB_BYTES);
+                fifo_address = read_register(lora, REG_FIFO_RX_CURRENT_ADDR);
+            }
+            lora->packet_index = 0;
+            lora->packet_length = packet_length;
+            lora->rx_done_us = event->timestamp_us;
+            lora->rx_airtime_us = time_on_air_us(lora, packet_length);
+            write_register(lora, REG_FIFO_ADDR_PTR, fifo_address);
+            if (!event->has_flags && lora->rx_queue.enabled) {
+                // Fila ativada depois da borda: copia aqui mesmo
+                rx_queue_push(lora, irq_flags, fifo_address, packet_length, event->timestamp_us);
+            }
+            if (lora->on_receive) {
+                lora->on_receive(lora, packet_length);
             }
         } else if (irq_flags & IRQ_TX_DONE_MASK) {
-            if (lora_instance.on_tx_done) {
-                lora_instance.on_tx_done();
+            lora->tx_done_us = event->timestamp_us;
+            lora->tx_airtime_us = time_on_air_us(lora, lora->payload_length);
+            if (lora->on_tx_done) {
+                lora->on_tx_done(lora);
             }
         }
     }
 }
 
-// Função de callback para interrupção GPIO
+// Função de callback para interrupção GPIO: só registra a borda, sem SPI
 static void gpio_callback(uint gpio, uint32_t events) {
-    if (gpio == lora_instance.dio0) {
-        handle_dio0_rise();
+    LoRa_t *lora = (gpio < NUM_BANK0_GPIOS) ? dio0_owner[gpio] : NULL;
+    if (!lora) return;
+
+    // Carimbo de tempo o mais perto possível da borda
+    uint64_t now = now_us(lora);
+
+    if (lora->tx_wait) {
+        // LoRa_end_packet(false) trata o TxDone fora da IRQ
+        lora->tx_edge_us = now;
+        lora->tx_edge = true;
+        return;
+    }
+
+    if (lora->tx_queue.active || lora->rx_queue.enabled) {
+        // Recarga da fila de TX e cópia do quadro recebido: o DIO0 só
+        // volta a subir depois que as flags forem limpas, então basta uma
+        // borda pendente por rádio
+        lora->deferred.edge_us = now;
+        lora->deferred.core = (uint8_t)get_core_num();
+        lora->deferred.pending = true;
+        int irq = deferred_irq[lora->deferred.core];
+        if (irq >= 0) {
+            irq_set_pending(irq);
+        } else {
+            // Sem IRQ de usuário livre: o trabalho fica aqui mesmo
+            deferred_run(lora);
+        }
+        return;
+    }
+
+    dio0_event_t event = {now, false, 0, 0, 0};
+    events_push(lora, &event);
+}
+
+static void events_push(LoRa_t *lora, const dio0_event_t *event) {
+    uint32_t head = lora->events.head;
+    if (head - lora->events.tail == LORA_EVENT_RING_SIZE) {
+        lora->events.dropped++;
+        return;
+    }
+    lora->events.slots[head % LORA_EVENT_RING_SIZE] = *event;
+    __dmb();
+    lora->events.head = head + 1;
+}
+
+// Reserva a IRQ de software do núcleo atual, na prioridade mais baixa: a
+// recarga da fila de TX e a cópia da fila de RX não atrasam as outras IRQs
+static void deferred_irq_init(void) {
+    uint core = get_core_num();
+    if (deferred_irq[core] >= 0) return;
+
+    int irq = user_irq_claim_unused(false);
+    if (irq < 0) return;
+    irq_set_exclusive_handler(irq, deferred_irq_handler);
+    irq_set_priority(irq, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(irq, true);
+    deferred_irq[core] = irq;
+}
+
+static void deferred_irq_handler(void) {
+    uint core = get_core_num();
+    for (int i = 0; i < lora_instance_count; i++) {
+        LoRa_t *lora = &lora_instances[i];
+        if (lora->deferred.pending && lora->deferred.core == core) {
+            deferred_run(lora);
+        }
+    }
+}
+
+// Trabalho da borda do DIO0 com as filas ativas. Exceção ao resto do
+// driver: o SPI roda em contexto de IRQ para o próximo quadro sair dezenas
+// de microssegundos após o TxDone (ou o recebido ir para a fila antes que o
+// próximo sobrescreva a FIFO). Com o lock do barramento a sequência inteira
+// fica entre duas transações do laço principal (ou do outro núcleo), nunca
+// no meio de uma.
+static void deferred_run(LoRa_t *lora) {
+    uint32_t status = bus_lock(lora);
+    lora->deferred.pending = false;
+    uint64_t now = lora->deferred.edge_us;
+
+    if (lora->tx_queue.active) {
+        if (lora->lbt.cad_pending) {
+            uint8_t irq_flags = read_register(lora, REG_IRQ_FLAGS);
+            write_register(lora, REG_IRQ_FLAGS, irq_flags);
+            lbt_cad_done(lora, irq_flags);
+        } else {
+            tx_queue_done(lora, now);
+        }
+        bus_unlock(lora, status);
+        return;
+    }
+
+    dio0_event_t event = {now, false, 0, 0, 0};
+    if (lora->rx_queue.enabled) {
+        // O quadro vai para a fila já no RxDone: um LoRa_poll_events
+        // atrasado (ou um anel cheio) não perde o pacote
+        rx_queue_capture(lora, &event);
     }
+    bus_unlock(lora, status);
+    events_push(lora, &event);
 }
 
-void LoRa_set_on_receive(void (*callback)(int)) {
-    lora_instance.on_receive = callback;
+// Faz o trabalho de SPI e chama os callbacks fora da IRQ.
+// Retorna o número de eventos tratados.
+int LoRa_poll_events(LoRa_t *lora) {
+    int handled = 0;
+    while (lora->events.tail != lora->events.head) {
+        __dmb();
+        handle_dio0_rise(lora, &lora->events.slots[lora->events.tail % LORA_EVENT_RING_SIZE]);
+        __dmb();
+        lora->events.tail++;
+        handled++;
+    }
+    return handled;
+}
+
+uint32_t LoRa_events_dropped(LoRa_t *lora) {
+    return lora->events.dropped;
+}
+
+// Borda do DIO0 com a fila de RX ativa (sob o lock do barramento): lê e limpa
+// as flags e, num RxDone sem erro de CRC, copia o quadro para a fila
+static void rx_queue_capture(LoRa_t *lora, dio0_event_t *event) {
+    event->irq_flags = read_register(lora, REG_IRQ_FLAGS);
+    write_register(lora, REG_IRQ_FLAGS, event->irq_flags);
+    event->has_flags = true;
+
+    if ((event->irq_flags & (IRQ_RX_DONE_MASK | IRQ_PAYLOAD_CRC_ERROR_MASK)) != IRQ_RX_DONE_MASK) return;
+    event->length = lora->implicit_header_mode ?
+        read_register(lora, REG_PAYLOAD_LENGTH) :
+        read_register(lora, REG_RX_NB_BYTES);
+    event->fifo_address = read_register(lora, REG_FIFO_RX_CURRENT_ADDR);
+    write_register(lora, REG_FIFO_ADDR_PTR, event->fifo_address);
+    rx_queue_push(lora, event->irq_flags, event->fifo_address, event->length, event->timestamp_us);
+}
+
+// Copia o quadro da FIFO para o próximo slot livre junto com os metadados;
+// fila cheia conta um overflow. O ponteiro da FIFO é restaurado para que
+// LoRa_read continue funcionando.
+static void rx_queue_push(LoRa_t *lora, uint8_t irq_flags, uint8_t fifo_address, int length, uint64_t timestamp_us) {
+    uint32_t head = lora->rx_queue.head;
+    if (head - lora->rx_queue.tail == LORA_RX_QUEUE_SLOTS) {
+        lora->rx_queue.overflows++;
+        return;
+    }
+
+    LoRa_rx_frame_t *frame = &lora->rx_queue.slots[head % LORA_RX_QUEUE_SLOTS];
+    read_burst(lora, REG_FIFO, frame->data, length);
+    dma_wait(lora);
+    write_register(lora, REG_FIFO_ADDR_PTR, fifo_address);
+
+    frame->length = length;
+    frame->rssi = LoRa_packet_rssi(lora);
+    frame->snr = LoRa_packet_snr(lora);
+    frame->frequency_error = frequency_error_hz(lora);
+    frame->irq_flags = irq_flags;
+    frame->timestamp_us = timestamp_us;
+    frame->start_us = timestamp_us - time_on_air_us(lora, length);
+
+    __dmb();
+    lora->rx_queue.head = head + 1;
+}
+
+void LoRa_set_rx_queue(LoRa_t *lora, bool enabled) {
+    lora->rx_queue.enabled = enabled;
+    if (enabled) {
+        gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    } else {
+        gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+    }
+}
+
+bool LoRa_rx_pop(LoRa_t *lora, LoRa_rx_frame_t *frame) {
+    uint32_t tail = lora->rx_queue.tail;
+    if (tail == lora->rx_queue.head) return false;
+
+    __dmb();
+    memcpy(frame, &lora->rx_queue.slots[tail % LORA_RX_QUEUE_SLOTS], sizeof(*frame));
+    __dmb();
+    lora->rx_queue.tail = tail + 1;
+    return true;
+}
+
+uint32_t LoRa_rx_overflows(LoRa_t *lora) {
+    return lora->rx_queue.overflows;
+}
+
+uint64_t LoRa_rx_done_us(LoRa_t *lora) {
+    return lora->rx_done_us;
+}
+
+// Início estimado do quadro: fim menos o tempo no ar calculado
+uint64_t LoRa_rx_start_us(LoRa_t *lora) {
+    return lora->rx_done_us - lora->rx_airtime_us;
+}
+
+uint64_t LoRa_tx_done_us(LoRa_t *lora) {
+    return lora->tx_done_us;
+}
+
+uint64_t LoRa_tx_start_us(LoRa_t *lora) {
+    return lora->tx_done_us - lora->tx_airtime_us;
+}
+
+uint32_t LoRa_time_on_air_us(LoRa_t *lora, int payload_length) {
+    return time_on_air_us(lora, payload_length);
+}
+
+// Duração de n símbolos, para dimensionar janelas de RX e timeouts
+uint32_t LoRa_symbols_to_us(LoRa_t *lora, uint32_t symbols) {
+    uint64_t us = ((uint64_t)symbols * symbol_time(lora)) >> 8;
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+// Dispara o pacote montado com begin_packet/write no instante absoluto at_us
+// (time_us_64) usando um alarme de hardware. O TxDone segue o caminho assíncrono.
+int LoRa_schedule_tx(LoRa_t *lora, uint64_t at_us) {
+    if (lora->tx_scheduled) return 0;
+
+    // Registradores já escritos aqui; o alarme só troca o modo
+    write_register(lora, REG_PAYLOAD_LENGTH, lora->payload_length);
+    if (lora->on_tx_done) {
+        write_register(lora, REG_DIO_MAPPING_1, 0x40);
+    }
+
+    // Pendente antes de armar: um prazo curto dispara antes de
+    // add_alarm_at retornar, e o callback é quem limpa o estado
+    lora->tx_alarm = 0;
+    lora->tx_scheduled = true;
+    alarm_id_t id = add_alarm_at(from_us_since_boot(at_us), scheduled_tx_callback, lora, true);
+    if (id < 0) {
+        lora->tx_scheduled = false;
+        return 0;
+    }
+
+    // O id só é guardado se o alarme ainda não disparou
+    uint32_t status = bus_lock(lora);
+    if (lora->tx_scheduled) lora->tx_alarm = id;
+    bus_unlock(lora, status);
+    return 1;
+}
+
+void LoRa_cancel_scheduled_tx(LoRa_t *lora) {
+    uint32_t status = bus_lock(lora);
+    alarm_id_t id = lora->tx_scheduled ? lora->tx_alarm : 0;
+    lora->tx_scheduled = false;
+    lora->tx_alarm = 0;
+    bus_unlock(lora, status);
+
+    // Se disparar antes do cancelamento, o callback já encontra tx_scheduled falso
+    if (id > 0) cancel_alarm(id);
+}
+
+// IRQ do alarme: a troca de modo sai sob o lock do barramento
+static int64_t scheduled_tx_callback(alarm_id_t id, void *user_data) {
+    LoRa_t *lora = (LoRa_t *)user_data;
+    uint32_t status = bus_lock(lora);
+    if (lora->tx_scheduled) {
+        lora->tx_scheduled = false;
+        lora->tx_alarm = 0;
+        if (lora->dma.busy) {
+            // FIFO ainda em carga: a IRQ do DMA dispara o TX ao terminar
+            lora->dma.pending_tx_async = true;
+            lora->dma.pending_tx = true;
+        } else {
+            write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_TX);
+        }
+    }
+    bus_unlock(lora, status);
+    return 0;
+}
+
+// Erro de frequência do último pacote, em Hz (registrador de 20 bits com sinal)
+static long frequency_error_hz(LoRa_t *lora) {
+    uint8_t raw[3];
+    read_burst(lora, REG_FREQ_ERROR_MSB, raw, 3);
+
+    int32_t freq_error = ((int32_t)(raw[0] & 0x0f) << 16) | (raw[1] << 8) | raw[2];
+    if (raw[0] & 0x08) {
+        freq_error -= (1 << 20);
+    }
+
+    // Ferr = FreqError * 2^24 / Fxtal * BW / 500 kHz
+    return (long)(((int64_t)freq_error * LoRa_get_signal_bandwidth(lora) * (1 << 24)) / (32000000LL * 500000LL));
+}
+
+void LoRa_set_on_receive(LoRa_t *lora, void (*callback)(LoRa_t *lora, int size)) {
+    lora->on_receive = callback;
     if (callback) {
-        gpio_set_irq_enabled_with_callback(lora_instance.dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+        gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
     } else {
-        gpio_set_irq_enabled(lora_instance.dio0, GPIO_IRQ_EDGE_RISE, false);
+        gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
     }
 }
 
-void LoRa_set_frequency(long frequency) {
-    lora_instance.frequency = frequency;
-    uint64_t frf = ((uint64_t)frequency << 19) / 32000000;
-    write_register(REG_FRF_MSB, (frf >> 16) & 0xFF);
-    write_register(REG_FRF_MID, (frf >> 8) & 0xFF);
-    write_register(REG_FRF_LSB, frf & 0xFF);
+// O DIO0 continua armado enquanto alguém consome os eventos de RX
+static bool dio0_irq_needed(LoRa_t *lora) {
+    return lora->on_receive != NULL || lora->on_tx_done != NULL ||
+           lora->on_cad_done != NULL || lora->rx_queue.enabled;
+}
+
+void LoRa_set_frequency(LoRa_t *lora, long frequency) {
+    lora->frequency = frequency;
+    uint32_t frf = frequency_to_frf(frequency);
+    uint8_t values[3] = {(frf >> 16) & 0xFF, (frf >> 8) & 0xFF, frf & 0xFF};
+    write_registers(lora, REG_FRF_MSB, values, 3);
+}
+
+static uint32_t frequency_to_frf(long frequency) {
+    return (uint32_t)(((uint64_t)frequency << 19) / 32000000);
 }
 
 // Funções restantes:
 
-void LoRa_explicit_header_mode(void) {
-    lora_instance.implicit_header_mode = 0;
-    write_register(REG_MODEM_CONFIG_1, read_register(REG_MODEM_CONFIG_1) & ~0x01);
+void LoRa_explicit_header_mode(LoRa_t *lora) {
+    lora->implicit_header_mode = 0;
+    write_register(lora, REG_MODEM_CONFIG_1, read_register(lora, REG_MODEM_CONFIG_1) & ~0x01);
 }
 
-void LoRa_implicit_header_mode(void) {
-    lora_instance.implicit_header_mode = 1;
-    write_register(REG_MODEM_CONFIG_1, read_register(REG_MODEM_CONFIG_1) | 0x01);
+void LoRa_implicit_header_mode(LoRa_t *lora) {
+    lora->implicit_header_mode = 1;
+    write_register(lora, REG_MODEM_CONFIG_1, read_register(lora, REG_MODEM_CONFIG_1) | 0x01);
 }
 
-void LoRa_set_coding_rate4(int denominator) {
+void LoRa_set_coding_rate4(LoRa_t *lora, int denominator) {
     int cr = (denominator < 5) ? 1 : (denominator > 8) ? 4 : (denominator - 4);
-    write_register(REG_MODEM_CONFIG_1, 
-        (read_register(REG_MODEM_CONFIG_1) & 0xf1) | (cr << 1));
+    write_register(lora, REG_MODEM_CONFIG_1, 
+        (read_register(lora, REG_MODEM_CONFIG_1) & 0xf1) | (cr << 1));
 }
 
-void LoRa_set_preamble_length(long length) {
-    write_register(REG_PREAMBLE_MSB, (uint8_t)(length >> 8));
-    write_register(REG_PREAMBLE_LSB, (uint8_t)(length & 0xFF));
+void LoRa_set_preamble_length(LoRa_t *lora, long length) {
+    write_register(lora, REG_PREAMBLE_MSB, (uint8_t)(length >> 8));
+    write_register(lora, REG_PREAMBLE_LSB, (uint8_t)(length & 0xFF));
 }
 
-int LoRa_get_spreading_factor(void) {
-    return read_register(REG_MODEM_CONFIG_2) >> 4;
+int LoRa_get_spreading_factor(LoRa_t *lora) {
+    return read_register(lora, REG_MODEM_CONFIG_2) >> 4;
 }
 
-long LoRa_get_signal_bandwidth(void) {
-    uint8_t bw = (read_register(REG_MODEM_CONFIG_1) >> 4);
-    const long bw_table[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+long LoRa_get_signal_bandwidth(LoRa_t *lora) {
+    uint8_t bw = (read_register(lora, REG_MODEM_CONFIG_1) >> 4);
     return (bw < 10) ? bw_table[bw] : -1;
 }
 
-void LoRa_set_signal_bandwidth(long sbw) {
+void LoRa_set_signal_bandwidth(LoRa_t *lora, long sbw) {
+    int bw = bandwidth_index(sbw);
+    write_register(lora, REG_MODEM_CONFIG_1, 
+        (read_register(lora, REG_MODEM_CONFIG_1) & 0x0f) | (bw << 4));
+    LoRa_set_ldo_flag(lora);
+}
+
+// Menor largura de banda suportada que comporta sbw
+static int bandwidth_index(long sbw) {
     int bw;
-    const long thresholds[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
-    for (bw = 9; bw > 0 && sbw <= thresholds[bw]; bw--);
-    write_register(REG_MODEM_CONFIG_1, 
-        (read_register(REG_MODEM_CONFIG_1) & 0x0f) | (bw << 4));
-    LoRa_set_ldo_flag();
+    for (bw = 0; bw < 9 && sbw > bw_table[bw]; bw++);
+    return bw;
 }
 
-void LoRa_enable_invert_iq(void) {
-    write_register(REG_INVERTIQ, 0x66);
-    write_register(REG_INVERTIQ2, 0x19);
+void LoRa_enable_invert_iq(LoRa_t *lora) {
+    write_register(lora, REG_INVERTIQ, 0x66);
+    write_register(lora, REG_INVERTIQ2, 0x19);
 }
 
-void LoRa_disable_invert_iq(void) {
-    write_register(REG_INVERTIQ, 0x27);
-    write_register(REG_INVERTIQ2, 0x1d);
+void LoRa_disable_invert_iq(LoRa_t *lora) {
+    write_register(lora, REG_INVERTIQ, 0x27);
+    write_register(lora, REG_INVERTIQ2, 0x1d);
+}
+
+// Troca de configuração completa entre pacotes: calcula a imagem dos
+// registradores uma vez, compara com a shadow e grava só o que mudou,
+// agrupando endereços contíguos (FRF 0x06-0x08, PREAMBLE 0x20-0x21) em rajadas
+void LoRa_apply_config(LoRa_t *lora, const LoRa_config_t *config) {
+    int sf = (config->spreading_factor < 6) ? 6 : (config->spreading_factor > 12) ? 12 : config->spreading_factor;
+    int bw = bandwidth_index(config->signal_bandwidth);
+    int cr = (config->coding_rate4 < 5) ? 1 : (config->coding_rate4 > 8) ? 4 : (config->coding_rate4 - 4);
+    uint32_t frf = frequency_to_frf(config->frequency);
+    uint8_t pa_dac, ocp, pa_config;
+    tx_power_registers(config->tx_power, &pa_dac, &ocp, &pa_config);
+
+    uint8_t config3 = read_register(lora, REG_MODEM_CONFIG_3) & ~(1 << 3);
+    if (ldo_required(bw_table[bw], sf)) config3 |= (1 << 3);
+
+    // Imagem ordenada por endereço
+    const struct {
+        uint8_t address;
+        uint8_t value;
+    } image[] = {
+        {REG_FRF_MSB, (frf >> 16) & 0xFF},
+        {REG_FRF_MID, (frf >> 8) & 0xFF},
+        {REG_FRF_LSB, frf & 0xFF},
+        {REG_PA_CONFIG, pa_config},
+        {REG_OCP, ocp},
+        {REG_MODEM_CONFIG_1, (read_register(lora, REG_MODEM_CONFIG_1) & 0x01) | (bw << 4) | (cr << 1)},
+        {REG_MODEM_CONFIG_2, (read_register(lora, REG_MODEM_CONFIG_2) & 0x0b) | (sf << 4) | (config->crc ? 0x04 : 0x00)},
+        {REG_PREAMBLE_MSB, (uint8_t)(config->preamble_length >> 8)},
+        {REG_PREAMBLE_LSB, (uint8_t)(config->preamble_length & 0xFF)},
+        {REG_MODEM_CONFIG_3, config3},
+        {REG_DETECTION_OPTIMIZE, (sf == 6) ? 0xc5 : 0xc3},
+        {REG_INVERTIQ, config->invert_iq ? 0x66 : 0x27},
+        {REG_DETECTION_THRESHOLD, (sf == 6) ? 0x0c : 0x0a},
+        {REG_SYNC_WORD, (uint8_t)config->sync_word},
+        {REG_INVERTIQ2, config->invert_iq ? 0x19 : 0x1d},
+        {REG_PA_DAC, pa_dac},
+    };
+    const size_t count = sizeof(image) / sizeof(image[0]);
+
+    uint8_t run[sizeof(image) / sizeof(image[0])];
+    size_t i = 0;
+    while (i < count) {
+        if (read_register(lora, image[i].address) == image[i].value) {
+            i++;
+            continue;
+        }
+        size_t n = 0;
+        uint8_t first = image[i].address;
+        do {
+            run[n++] = image[i++].value;
+        } while (i < count && image[i].address == first + n &&
+                 read_register(lora, image[i].address) != image[i].value);
+        write_registers(lora, first, run, n);
+    }
+
+    lora->frequency = config->frequency;
 }
 
 // Funções de acesso ao hardware
-static uint8_t single_transfer(uint8_t address, uint8_t value) {
-    uint8_t response;
-    gpio_put(lora_instance.ss, 0);
-    spi_write_blocking(lora_instance.spi, &address, 1);
-    spi_write_read_blocking(lora_instance.spi, &value, &response, 1);
-    gpio_put(lora_instance.ss, 1);
+
+// Toda transação roda com as IRQs do núcleo mascaradas e o spin lock do
+// rádio: uma IRQ (GPIO, alarme, DMA) que usa o SPI nunca entra no meio de
+// uma transação do laço principal, e o outro núcleo espera a vez. Uma
+// rajada de DMA ainda em curso é concluída pelo próximo acesso (dma_wait no
+// transporte). Reentrante no mesmo núcleo: as IRQs podem agrupar várias
+// transações sob um único lock.
+static uint32_t bus_lock(LoRa_t *lora) {
+    uint32_t status = save_and_disable_interrupts();
+    int8_t core = (int8_t)get_core_num();
+    if (lora->bus.owner != core) {
+        spin_lock_unsafe_blocking(lora->bus.lock);
+        lora->bus.owner = core;
+    }
+    lora->bus.depth++;
+    return status;
+}
+
+static void bus_unlock(LoRa_t *lora, uint32_t status) {
+    if (--lora->bus.depth == 0) {
+        lora->bus.owner = -1;
+        spin_unlock_unsafe(lora->bus.lock);
+    }
+    restore_interrupts(status);
+}
+
+// Acesso a um registrador; o bit 7 do endereço indica escrita
+static uint8_t single_transfer(LoRa_t *lora, uint8_t address, uint8_t value) {
+    uint8_t response = 0;
+    uint32_t status = bus_lock(lora);
+    if (address & 0x80) {
+        lora->transport->write_burst(lora->transport_context, address & 0x7f, &value, 1);
+    } else {
+        lora->transport->read_burst(lora->transport_context, address, &response, 1);
+    }
+    bus_unlock(lora, status);
     return response;
 }
 
-static uint8_t read_register(uint8_t address) {
-    return single_transfer(address & 0x7f, 0x00);
+static uint8_t read_register(LoRa_t *lora, uint8_t address) {
+    address &= 0x7f;
+    if (!shadow_cacheable(address)) {
+        return single_transfer(lora, address, 0x00);
+    }
+
+    uint32_t bit = 1u << (address % 32);
+    if (!(lora->shadow_valid[address / 32] & bit)) {
+        lora->shadow[address] = single_transfer(lora, address, 0x00);
+        lora->shadow_valid[address / 32] |= bit;
+    }
+    return lora->shadow[address];
+}
+
+static void write_register(LoRa_t *lora, uint8_t address, uint8_t value) {
+    single_transfer(lora, address | 0x80, value);
+
+    address &= 0x7f;
+    if (shadow_cacheable(address)) {
+        lora->shadow[address] = value;
+        lora->shadow_valid[address / 32] |= 1u << (address % 32);
+    }
+}
+
+// Registradores que só mudam por escrita do driver. REG_OP_MODE fica de fora:
+// o próprio chip volta para STDBY ao fim do TX e do RX_SINGLE.
+static bool shadow_cacheable(uint8_t address) {
+    switch (address) {
+    case REG_FRF_MSB:
+    case REG_FRF_MID:
+    case REG_FRF_LSB:
+    case REG_PA_CONFIG:
+    case REG_OCP:
+    case REG_LNA:
+    case REG_FIFO_TX_BASE_ADDR:
+    case REG_FIFO_RX_BASE_ADDR:
+    case REG_MODEM_CONFIG_1:
+    case REG_MODEM_CONFIG_2:
+    case REG_PREAMBLE_MSB:
+    case REG_PREAMBLE_LSB:
+    case REG_MODEM_CONFIG_3:
+    case REG_DETECTION_OPTIMIZE:
+    case REG_INVERTIQ:
+    case REG_DETECTION_THRESHOLD:
+    case REG_SYNC_WORD:
+    case REG_INVERTIQ2:
+    case REG_DIO_MAPPING_1:
+    case REG_PA_DAC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void LoRa_invalidate_shadow(LoRa_t *lora) {
+    memset(lora->shadow_valid, 0, sizeof(lora->shadow_valid));
+}
+
+// Depuração: compara a shadow com o chip e retorna o número de divergências
+int LoRa_verify_shadow(LoRa_t *lora) {
+    int mismatches = 0;
+    for (uint8_t address = 0; address < SHADOW_SIZE; address++) {
+        if (!(lora->shadow_valid[address / 32] & (1u << (address % 32)))) continue;
+        if (single_transfer(lora, address, 0x00) != lora->shadow[address]) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Escrita em rajada: o SX127x incrementa o endereço (ou avança a FIFO)
+// a cada byte enquanto o CS permanecer em nível baixo
+static void write_burst(LoRa_t *lora, uint8_t address, const uint8_t *buffer, size_t size) {
+    if (size == 0) return;
+    uint32_t status = bus_lock(lora);
+    lora->transport->write_burst(lora->transport_context, address & 0x7f, buffer, size);
+    bus_unlock(lora, status);
+}
+
+static void read_burst(LoRa_t *lora, uint8_t address, uint8_t *buffer, size_t size) {
+    if (size == 0) return;
+    uint32_t status = bus_lock(lora);
+    lora->transport->read_burst(lora->transport_context, address & 0x7f, buffer, size);
+    bus_unlock(lora, status);
+}
+
+static uint64_t now_us(LoRa_t *lora) {
+    return lora->transport->time_us(lora->transport_context);
+}
+
+// Rajada sobre registradores de configuração, mantendo a shadow em dia
+static void write_registers(LoRa_t *lora, uint8_t address, const uint8_t *values, size_t size) {
+    if (size == 1) {
+        write_register(lora, address, values[0]);
+        return;
+    }
+    write_burst(lora, address, values, size);
+    for (size_t i = 0; i < size; i++) {
+        uint8_t reg = address + i;
+        if (shadow_cacheable(reg)) {
+            lora->shadow[reg] = values[i];
+            lora->shadow_valid[reg / 32] |= 1u << (reg % 32);
+        }
+    }
+}
+
+// Transporte do RP2040 -------------------------------------------------------
+
+// Rajadas com CS próprio; rajadas da FIFO com mais de um byte podem seguir
+// por DMA (ver dma_wait). Um byte só (read_register/LoRa_read) é sempre
+// bloqueante: o destino é uma variável local de single_transfer.
+static void rp2040_write_burst(void *context, uint8_t address, const uint8_t *buffer, size_t size) {
+    LoRa_t *lora = (LoRa_t *)context;
+    address |= 0x80;
+    if (lora->pio) {
+        pio_transfer(lora, address, buffer, NULL, size);
+        return;
+    }
+    dma_wait(lora);
+    gpio_put(lora->ss, 0);
+    spi_write_blocking(lora->spi, &address, 1);
+    if (lora->dma.tx_channel >= 0 && (address & 0x7f) == REG_FIFO && size > 1) {
+        dma_start(lora, buffer, true, &lora->dma.dummy, false, size);
+        return;
+    }
+    spi_write_blocking(lora->spi, buffer, size);
+    gpio_put(lora->ss, 1);
+}
+
+static void rp2040_read_burst(void *context, uint8_t address, uint8_t *buffer, size_t size) {
+    LoRa_t *lora = (LoRa_t *)context;
+    if (lora->pio) {
+        pio_transfer(lora, address, NULL, buffer, size);
+        return;
+    }
+    dma_wait(lora);
+    gpio_put(lora->ss, 0);
+    spi_write_blocking(lora->spi, &address, 1);
+    if (lora->dma.tx_channel >= 0 && address == REG_FIFO && size > 1) {
+        lora->dma.dummy = 0x00;
+        dma_start(lora, &lora->dma.dummy, false, buffer, true, size);
+        return;
+    }
+    spi_read_blocking(lora->spi, 0x00, buffer, size);
+    gpio_put(lora->ss, 1);
+}
+
+static void rp2040_delay_us(void *context, uint32_t us) {
+    sleep_us(us);
+}
+
+static uint64_t rp2040_time_us(void *context) {
+    return time_us_64();
+}
+
+// Backend PIO
+
+static bool pio_backend_init(LoRa_t *lora) {
+    uint index = pio_get_index(lora->pio);
+    if (pio_program_offset[index] < 0) {
+        if (!pio_can_add_program(lora->pio, &sx127x_spi_program)) return false;
+        pio_program_offset[index] = pio_add_program(lora->pio, &sx127x_spi_program);
+    }
+
+    int sm = pio_claim_unused_sm(lora->pio, false);
+    if (sm < 0) return false;
+    lora->pio_sm = sm;
+
+    float clkdiv = (float)clock_get_hz(clk_sys) / (4.0f * lora->spi_frequency);
+    if (clkdiv < 1.0f) clkdiv = 1.0f;
+    sx127x_spi_program_init(lora->pio, lora->pio_sm, pio_program_offset[index], clkdiv,
+                            lora->sck, lora->mosi, lora->miso, lora->ss);
+    lora->spi_frequency = clock_get_hz(clk_sys) / (4.0f * clkdiv);
+    return true;
+}
+
+// Uma transação completa: endereço mais size bytes. A TX FIFO é alimentada
+// enquanto a RX FIFO é esvaziada, para a state machine nunca parar no autopush.
+static void pio_transfer(LoRa_t *lora, uint8_t address, const uint8_t *tx, uint8_t *rx, size_t size) {
+    PIO pio = lora->pio;
+    uint sm = lora->pio_sm;
+    uint32_t bits = 8 * (size + 1);
+
+    pio_sm_put_blocking(pio, sm, ((bits - 1) << 16) | (address << 8) | (tx ? tx[0] : 0));
+
+    size_t queued = 1;
+    size_t received = 0;
+    while (received < size + 1) {
+        if (queued < size && !pio_sm_is_tx_fifo_full(pio, sm)) {
+            uint32_t word = 0;
+            for (int i = 0; i < 4; i++) {
+                word <<= 8;
+                if (tx && queued + i < size) word |= tx[queued + i];
+            }
+            queued += (size - queued < 4) ? size - queued : 4;
+            pio_sm_put(pio, sm, word);
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            uint8_t byte = (uint8_t)pio_sm_get(pio, sm);
+            // O primeiro byte é o status devolvido durante o endereço
+            if (received > 0 && rx) rx[received - 1] = byte;
+            received++;
+        }
+    }
+}
+
+// Ajusta o clock do barramento e devolve o valor real obtido
+static uint32_t link_set_rate(LoRa_t *lora, uint32_t frequency) {
+    if (!lora->pio) {
+        return spi_set_baudrate(lora->spi, frequency);
+    }
+    float clkdiv = (float)clock_get_hz(clk_sys) / (4.0f * frequency);
+    if (clkdiv < 1.0f) clkdiv = 1.0f;
+    pio_sm_set_clkdiv(lora->pio, lora->pio_sm, clkdiv);
+    return clock_get_hz(clk_sys) / (4.0f * clkdiv);
 }
 
-static void write_register(uint8_t address, uint8_t value) {
-    single_transfer(address | 0x80, value);
+// Transporte por DMA
+
+bool LoRa_enable_dma(LoRa_t *lora, void (*on_done)(LoRa_t *lora)) {
+    // O backend PIO não usa os DREQs do SPI; segue em modo bloqueante
+    if (lora->pio) return false;
+
+    if (lora->dma.tx_channel >= 0) {
+        lora->dma.on_done = on_done;
+        return true;
+    }
+
+    int tx = dma_claim_unused_channel(false);
+    int rx = dma_claim_unused_channel(false);
+    if (tx < 0 || rx < 0) {
+        // Sem canais livres: permanece no modo bloqueante
+        if (tx >= 0) dma_channel_unclaim(tx);
+        if (rx >= 0) dma_channel_unclaim(rx);
+        return false;
+    }
+
+    lora->dma.on_done = on_done;
+    lora->dma.busy = false;
+    lora->dma.pending_tx = false;
+    lora->dma.pending_tx_async = false;
+
+    if (dma_irq_users++ == 0) {
+        irq_add_shared_handler(DMA_IRQ_0, dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+    dma_channel_set_irq0_enabled(rx, true);
+
+    lora->dma.tx_channel = tx;
+    lora->dma.rx_channel = rx;
+    return true;
+}
+
+void LoRa_disable_dma(LoRa_t *lora) {
+    if (lora->dma.tx_channel < 0) return;
+    dma_wait(lora);
+
+    dma_channel_set_irq0_enabled(lora->dma.rx_channel, false);
+    if (--dma_irq_users == 0) {
+        irq_remove_handler(DMA_IRQ_0, dma_irq_handler);
+    }
+    dma_channel_unclaim(lora->dma.tx_channel);
+    dma_channel_unclaim(lora->dma.rx_channel);
+    lora->dma.tx_channel = -1;
+    lora->dma.rx_channel = -1;
+}
+
+bool LoRa_dma_busy(LoRa_t *lora) {
+    return lora->dma.busy;
+}
+
+// Dispara a rajada com o CS já em nível baixo e o endereço enviado.
+// O canal RX termina por último, então sua IRQ marca o fim da transação.
+static void dma_start(LoRa_t *lora, const volatile void *src, bool src_incr, volatile void *dst, bool dst_incr, size_t size) {
+    spi_inst_t *spi = lora->spi;
+    dma_channel_config c;
+
+    lora->dma.busy = true;
+
+    c = dma_channel_get_default_config(lora->dma.tx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, true));
+    channel_config_set_read_increment(&c, src_incr);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(lora->dma.tx_channel, &c, &spi_get_hw(spi)->dr, src, size, false);
+
+    c = dma_channel_get_default_config(lora->dma.rx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, dst_incr);
+    dma_channel_configure(lora->dma.rx_channel, &c, dst, &spi_get_hw(spi)->dr, size, false);
+
+    dma_start_channel_mask((1u << lora->dma.tx_channel) | (1u << lora->dma.rx_channel));
+}
+
+// Fallback bloqueante: qualquer acesso ao SPI aguarda a rajada em andamento
+static void dma_wait(LoRa_t *lora) {
+    if (!lora->dma.busy) return;
+    uint32_t status = bus_lock(lora);
+    // A IRQ do DMA pode ter concluído a rajada antes do lock
+    if (lora->dma.busy) {
+        dma_channel_wait_for_finish_blocking(lora->dma.rx_channel);
+        dma_complete(lora);
+    }
+    bus_unlock(lora, status);
+}
+
+// Fim da rajada (IRQ do DMA ou dma_wait). O CS e o TX adiado saem sob o lock
+// do barramento, para não cair no meio de uma transação de outro contexto;
+// on_done roda depois de soltá-lo (ainda dentro do lock de quem chamou
+// dma_wait, se for o caso).
+static void dma_complete(LoRa_t *lora) {
+    uint32_t status = bus_lock(lora);
+    if (!lora->dma.busy) {
+        bus_unlock(lora, status);
+        return;
+    }
+    dma_channel_acknowledge_irq0(lora->dma.rx_channel);
+    gpio_put(lora->ss, 1);
+    lora->dma.busy = false;
+
+    if (lora->dma.pending_tx) {
+        lora->dma.pending_tx = false;
+        start_tx(lora, lora->dma.pending_tx_async);
+    }
+    bus_unlock(lora, status);
+
+    if (lora->dma.on_done) {
+        lora->dma.on_done(lora);
+    }
+}
+
+static void dma_irq_handler(void) {
+    for (int i = 0; i < lora_instance_count; i++) {
+        LoRa_t *lora = &lora_instances[i];
+        if (lora->dma.rx_channel < 0) continue;
+        if (!dma_channel_get_irq0_status(lora->dma.rx_channel)) continue;
+        dma_complete(lora);
+    }
+}
+
+// Fila de TX ------------------------------------------------------------------
+
+// Enfileira um quadro; se o rádio estiver parado a rajada começa aqui.
+// Retorna 0 com a fila cheia.
+int LoRa_tx_enqueue(LoRa_t *lora, const uint8_t *buffer, size_t size) {
+    uint32_t head = lora->tx_queue.head;
+    if (size > MAX_PKT_LENGTH || head - lora->tx_queue.tail == LORA_TX_QUEUE_SLOTS) return 0;
+
+    memcpy(lora->tx_queue.slots[head % LORA_TX_QUEUE_SLOTS].data, buffer, size);
+    lora->tx_queue.slots[head % LORA_TX_QUEUE_SLOTS].length = size;
+    __dmb();
+    lora->tx_queue.head = head + 1;
+
+    // Mesmo lock da recarga no TxDone: a partida não se mistura com ela
+    uint32_t status = bus_lock(lora);
+    if (!lora->tx_queue.active) {
+        lora->tx_queue.active = true;
+        if (lora->tx_queue.packets == 0) {
+            lora->tx_queue.first_start_us = now_us(lora);
+        }
+        gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+        LoRa_idle(lora);
+        tx_queue_next(lora);
+    }
+    bus_unlock(lora, status);
+    return 1;
+}
+
+int LoRa_tx_queue_pending(LoRa_t *lora) {
+    return lora->tx_queue.head - lora->tx_queue.tail;
+}
+
+void LoRa_tx_queue_get_stats(LoRa_t *lora, LoRa_tx_queue_stats_t *stats) {
+    uint32_t status = save_and_disable_interrupts();
+    uint64_t elapsed = lora->tx_queue.last_done_us - lora->tx_queue.first_start_us;
+    stats->packets = lora->tx_queue.packets;
+    stats->elapsed_us = lora->tx_queue.packets ? elapsed : 0;
+    stats->airtime_us = lora->tx_queue.airtime_sum_us;
+    stats->idle_us = stats->elapsed_us > stats->airtime_us ? stats->elapsed_us - stats->airtime_us : 0;
+    stats->gap_max_us = lora->tx_queue.gap_max_us;
+    stats->gap_avg_us = lora->tx_queue.packets > 1 ?
+        lora->tx_queue.gap_sum_us / (lora->tx_queue.packets - 1) : 0;
+    restore_interrupts(status);
+
+    stats->packets_per_second = stats->elapsed_us ?
+        stats->packets * 1000000.0f / stats->elapsed_us : 0.0f;
+}
+
+void LoRa_tx_queue_reset_stats(LoRa_t *lora) {
+    uint32_t status = save_and_disable_interrupts();
+    lora->tx_queue.packets = 0;
+    lora->tx_queue.first_start_us = now_us(lora);
+    lora->tx_queue.airtime_sum_us = 0;
+    lora->tx_queue.gap_sum_us = 0;
+    lora->tx_queue.gap_max_us = 0;
+    restore_interrupts(status);
+}
+
+// Carrega o quadro em tail na FIFO e dispara o TX. Com DMA a FIFO é
+// preenchida em segundo plano e o TX sai pela IRQ do DMA.
+static void tx_queue_load(LoRa_t *lora) {
+    uint32_t tail = lora->tx_queue.tail;
+    uint8_t length = lora->tx_queue.slots[tail % LORA_TX_QUEUE_SLOTS].length;
+
+    lora->tx_queue.airtime_us = time_on_air_us(lora, length);
+    write_register(lora, REG_FIFO_ADDR_PTR, 0);
+    lora->payload_length = length;
+    write_burst(lora, REG_FIFO, lora->tx_queue.slots[tail % LORA_TX_QUEUE_SLOTS].data, length);
+
+    if (lora->dma.busy) {
+        lora->dma.pending_tx_async = true;
+        lora->dma.pending_tx = true;
+    } else {
+        start_tx(lora, true);
+    }
+}
+
+// TxDone com a fila ativa (contexto de IRQ). O slot só é liberado aqui,
+// pois o DMA lê a FIFO direto dele.
+static void tx_queue_done(LoRa_t *lora, uint64_t now) {
+    write_register(lora, REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);
+
+    lora->tx_queue.packets++;
+    lora->tx_queue.airtime_sum_us += lora->tx_queue.airtime_us;
+    lora->tx_queue.last_done_us = now;
+    lora->tx_done_us = now;
+    lora->tx_airtime_us = lora->tx_queue.airtime_us;
+
+    __dmb();
+    lora->tx_queue.tail++;
+    if (lora->tx_queue.tail != lora->tx_queue.head) {
+        tx_queue_next(lora);
+        return;
+    }
+
+    // Fila vazia: o rádio fica em standby
+    lora->tx_queue.active = false;
+    gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+}
+
+// Próximo quadro da fila: direto para o TX ou, com LBT, primeiro um CAD
+static void tx_queue_next(LoRa_t *lora) {
+    if (lora->lbt.enabled) {
+        lbt_start_cad(lora);
+    } else {
+        tx_queue_load(lora);
+    }
+}
+
+// Listen-before-talk -------------------------------------------------------
+
+// slot_us é a unidade do backoff exponencial: após n CADs ocupados o
+// quadro espera um tempo aleatório em [0, 2^n * slot_us). Depois de
+// max_attempts CADs ocupados o quadro é descartado (0 = nunca).
+void LoRa_set_lbt(LoRa_t *lora, bool enabled, uint32_t slot_us, uint8_t max_attempts) {
+    lora->lbt.enabled = enabled;
+    lora->lbt.slot_us = slot_us;
+    lora->lbt.max_attempts = max_attempts;
+
+    // Semente: relógio mais o ruído do RSSI de banda larga
+    lora->lbt.rng = (uint32_t)now_us(lora) ^ ((uint32_t)read_register(lora, REG_RSSI_WIDEBAND) << 24);
+    if (lora->lbt.rng == 0) lora->lbt.rng = 1;
+}
+
+void LoRa_lbt_get_stats(LoRa_t *lora, LoRa_lbt_stats_t *stats) {
+    uint32_t status = save_and_disable_interrupts();
+    *stats = lora->lbt.stats;
+    restore_interrupts(status);
+}
+
+void LoRa_lbt_reset_stats(LoRa_t *lora) {
+    uint32_t status = save_and_disable_interrupts();
+    memset(&lora->lbt.stats, 0, sizeof(lora->lbt.stats));
+    restore_interrupts(status);
+}
+
+static void lbt_start_cad(LoRa_t *lora) {
+    lora->lbt.cad_pending = true;
+    lora->lbt.stats.cad_runs++;
+    write_register(lora, REG_DIO_MAPPING_1, 0x80);
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
+}
+
+// CadDone de um quadro da fila (contexto de IRQ)
+static void lbt_cad_done(LoRa_t *lora, uint8_t irq_flags) {
+    lora->lbt.cad_pending = false;
+
+    if (!(irq_flags & IRQ_CAD_DETECTED_MASK)) {
+        lora->lbt.attempts = 0;
+        tx_queue_load(lora);
+        return;
+    }
+
+    lora->lbt.stats.cad_busy++;
+    if (lora->lbt.attempts < 255) lora->lbt.attempts++;
+    if (lora->lbt.max_attempts && lora->lbt.attempts >= lora->lbt.max_attempts) {
+        // Canal ocupado demais: descarta o quadro e segue a fila
+        lora->lbt.stats.dropped++;
+        lora->lbt.attempts = 0;
+        __dmb();
+        lora->tx_queue.tail++;
+        if (lora->tx_queue.tail != lora->tx_queue.head) {
+            lbt_start_cad(lora);
+        } else {
+            lora->tx_queue.active = false;
+            gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+        }
+        return;
+    }
+
+    uint32_t x = lora->lbt.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    lora->lbt.rng = x;
+
+    int exponent = lora->lbt.attempts < LORA_LBT_MAX_BACKOFF_EXP ? lora->lbt.attempts : LORA_LBT_MAX_BACKOFF_EXP;
+    uint32_t window = lora->lbt.slot_us << exponent;
+    uint32_t delay = window ? x % window : 0;
+
+    // Como em LoRa_schedule_tx: o alarme pode disparar antes de o id voltar
+    lora->lbt.backoff = true;
+    alarm_id_t id = add_alarm_in_us(delay, lbt_backoff_callback, lora, true);
+    if (id < 0 && lora->lbt.backoff) {
+        // Sem alarme livre: refaz o CAD já, em vez de deixar a fila parada
+        lora->lbt.backoff = false;
+        lbt_start_cad(lora);
+        return;
+    }
+    lora->lbt.alarm = lora->lbt.backoff && id > 0 ? id : 0;
+    lora->lbt.stats.backoffs++;
+    lora->lbt.stats.backoff_sum_us += delay;
+}
+
+// IRQ do alarme: o CAD sai sob o lock do barramento, como no TxDone.
+// Um backoff cancelado (LoRa_tx_queue_flush) não faz nada.
+static int64_t lbt_backoff_callback(alarm_id_t id, void *user_data) {
+    LoRa_t *lora = (LoRa_t *)user_data;
+    uint32_t status = bus_lock(lora);
+    if (lora->lbt.backoff) {
+        lora->lbt.backoff = false;
+        lora->lbt.alarm = 0;
+        lbt_start_cad(lora);
+    }
+    bus_unlock(lora, status);
+    return 0;
+}
+
+// Descarta os quadros ainda na fila de TX (inclusive o que aguarda CAD ou
+// backoff), cancela o alarme do LBT e deixa o rádio em standby. Um quadro
+// que já está no ar é interrompido. Retorna quantos quadros foram
+// descartados.
+int LoRa_tx_queue_flush(LoRa_t *lora) {
+    // A rajada de DMA em curso lê direto de um slot da fila
+    dma_wait(lora);
+
+    uint32_t status = bus_lock(lora);
+    alarm_id_t id = lora->lbt.backoff ? lora->lbt.alarm : 0;
+    lora->lbt.backoff = false;
+    lora->lbt.alarm = 0;
+    lora->lbt.cad_pending = false;
+    lora->lbt.attempts = 0;
+
+    int dropped = lora->tx_queue.head - lora->tx_queue.tail;
+    bool active = lora->tx_queue.active;
+    lora->tx_queue.tail = lora->tx_queue.head;
+    lora->tx_queue.active = false;
+    lora->deferred.pending = false;
+    if (active) {
+        lora->dma.pending_tx = false;
+        LoRa_idle(lora);
+        write_register(lora, REG_IRQ_FLAGS, IRQ_TX_DONE_MASK | IRQ_CAD_DONE_MASK | IRQ_CAD_DETECTED_MASK);
+        gpio_set_irq_enabled(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora));
+    }
+    bus_unlock(lora, status);
+
+    // Se disparar antes do cancelamento, o callback já encontra backoff falso
+    if (id > 0) cancel_alarm(id);
+    return dropped;
+}
+
+// CAD avulso: o resultado chega em on_cad_done via LoRa_poll_events, e o
+// DIO0 volta ao estado anterior. Recusado (retorna 0) enquanto a fila de
+// TX estiver ativa: o CAD dela é do LBT.
+int LoRa_channel_activity_detection(LoRa_t *lora) {
+    uint32_t status = bus_lock(lora);
+    if (lora->tx_queue.active || lora->lbt.cad_pending || lora->lbt.backoff) {
+        bus_unlock(lora, status);
+        return 0;
+    }
+    lora->cad_active = true;
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    write_register(lora, REG_DIO_MAPPING_1, 0x80);
+    write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
+    bus_unlock(lora, status);
+    return 1;
+}
+
+void LoRa_set_on_cad_done(LoRa_t *lora, void (*callback)(LoRa_t *lora, bool detected)) {
+    lora->on_cad_done = callback;
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora), &gpio_callback);
+}
+
+void LoRa_set_on_tx_done(LoRa_t *lora, void (*callback)(LoRa_t *lora)) {
+    lora->on_tx_done = callback;
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, dio0_irq_needed(lora), &gpio_callback);
+}
+
+// AFC -----------------------------------------------------------------------
+
+// shift define o peso das novas medidas: EWMA com alfa = 1 / 2^shift.
+// Limitado a 16: alfa < 1/65536 já não acompanha deriva nenhuma.
+void LoRa_set_afc(LoRa_t *lora, bool enabled, uint8_t shift) {
+    lora->afc.enabled = enabled;
+    lora->afc.shift = shift > 16 ? 16 : shift;
+    if (!enabled) {
+        memset(lora->afc.peers, 0, sizeof(lora->afc.peers));
+    }
+}
+
+// Registra o erro de frequência medido num pacote do par (por exemplo
+// LoRa_packet_frequency_error ou LoRa_rx_frame_t.frequency_error)
+void LoRa_afc_observe(LoRa_t *lora, uint32_t peer, long frequency_error) {
+    if (!lora->afc.enabled) return;
+
+    // Entrada do par; senão uma livre (last_used = 0) ou a menos usada
+    int slot = 0;
+    for (int i = 0; i < LORA_AFC_PEERS; i++) {
+        if (lora->afc.peers[i].samples && lora->afc.peers[i].peer == peer) {
+            slot = i;
+            break;
+        }
+        if (lora->afc.peers[i].last_used < lora->afc.peers[slot].last_used) slot = i;
+    }
+
+    // Q16 e arredondamento antes do deslocamento: erros pequenos ainda movem
+    // a média, e o >> de diferenças negativas não a puxa para baixo
+    int64_t sample_q16 = (int64_t)frequency_error * 65536;
+    if (!lora->afc.peers[slot].samples || lora->afc.peers[slot].peer != peer) {
+        lora->afc.peers[slot].peer = peer;
+        lora->afc.peers[slot].offset_q16 = sample_q16;
+        lora->afc.peers[slot].samples = 1;
+    } else {
+        int64_t diff = sample_q16 - lora->afc.peers[slot].offset_q16;
+        uint8_t shift = lora->afc.shift;
+        if (shift) {
+            // Arredonda o módulo, para o passo ser simétrico nos dois sentidos
+            int64_t half = (int64_t)1 << (shift - 1);
+            diff = diff >= 0 ? (diff + half) >> shift : -((-diff + half) >> shift);
+        }
+        lora->afc.peers[slot].offset_q16 += diff;
+        if (lora->afc.peers[slot].samples < UINT16_MAX) lora->afc.peers[slot].samples++;
+    }
+    lora->afc.peers[slot].last_used = ++lora->afc.clock;
+}
+
+// Desvio estimado do par em Hz (0 sem medidas)
+long LoRa_afc_offset(LoRa_t *lora, uint32_t peer) {
+    for (int i = 0; i < LORA_AFC_PEERS; i++) {
+        if (lora->afc.peers[i].samples && lora->afc.peers[i].peer == peer) {
+            return (long)((lora->afc.peers[i].offset_q16 + 32768) >> 16);
+        }
+    }
+    return 0;
+}
+
+// Antes do TX para o par: desloca o FRF pelo desvio estimado, de modo que o
+// sinal chegue centrado no oscilador dele. lora->frequency não muda.
+void LoRa_afc_retune(LoRa_t *lora, uint32_t peer) {
+    long offset = lora->afc.enabled ? LoRa_afc_offset(lora, peer) : 0;
+    uint32_t frf = frequency_to_frf(lora->frequency + offset);
+    uint8_t values[3] = {(frf >> 16) & 0xFF, (frf >> 8) & 0xFF, frf & 0xFF};
+    write_registers(lora, REG_FRF_MSB, values, 3);
+}
+
+// Volta para a frequência nominal (RX ou TX em broadcast)
+void LoRa_afc_restore(LoRa_t *lora) {
+    LoRa_set_frequency(lora, lora->frequency);
+}
+
+// RX com ciclo de trabalho -------------------------------------------------
+
+// Alterna rx_us em RX contínuo com sleep_us em sleep. Um pacote que chega
+// durante a janela é tratado normalmente por LoRa_poll_events; se o modem
+// ainda estiver recebendo quando a janela acaba, ou se o pacote ainda não
+// foi lido da FIFO (o sleep a apagaria), ela é estendida.
+// Os transmissores precisam de um preâmbulo que cubra sleep_us + rx_us
+// (ver LoRa_duty_cycle_estimate).
+int LoRa_receive_duty_cycled(LoRa_t *lora, uint32_t rx_us, uint32_t sleep_us) {
+    LoRa_stop_duty_cycled(lora);
+
+    lora->sniff.rx_us = rx_us;
+    lora->sniff.sleep_us = sleep_us;
+    lora->sniff.windows = 1;
+    lora->sniff.extended = 0;
+    lora->sniff.listening = true;
+    lora->sniff.active = true;
+
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    LoRa_receive(lora, 0);
+
+    lora->sniff.alarm = add_alarm_in_us(rx_us, sniff_callback, lora, true);
+    if (lora->sniff.alarm < 0) {
+        lora->sniff.active = false;
+        return 0;
+    }
+    return 1;
+}
+
+// Encerra o ciclo e deixa o rádio em standby, como LoRa_idle. Sob o lock do
+// barramento: um sniff_callback em curso termina antes, e um que dispare
+// depois já encontra active falso.
+void LoRa_stop_duty_cycled(LoRa_t *lora) {
+    uint32_t status = bus_lock(lora);
+    if (!lora->sniff.active) {
+        bus_unlock(lora, status);
+        return;
+    }
+    alarm_id_t id = lora->sniff.alarm;
+    lora->sniff.active = false;
+    lora->sniff.alarm = 0;
+    LoRa_idle(lora);
+    bus_unlock(lora, status);
+
+    if (id > 0) cancel_alarm(id);
+}
+
+// Pacote recebido e ainda não consumido: borda ainda na fila de eventos ou
+// bytes que a aplicação não leu da FIFO. Com a fila de RX e sem on_receive o
+// quadro já foi copiado na IRQ e a FIFO não faz mais falta.
+static bool rx_unread(LoRa_t *lora) {
+    if (lora->events.tail != lora->events.head) return true;
+    if (lora->rx_queue.enabled && !lora->on_receive) return false;
+    return LoRa_available(lora) > 0;
+}
+
+// IRQ do alarme, com o SPI sob o lock do barramento.
+// Retornos negativos reagendam o alarme a partir de agora.
+static int64_t sniff_callback(alarm_id_t id, void *user_data) {
+    LoRa_t *lora = (LoRa_t *)user_data;
+    int64_t next;
+    uint32_t status = bus_lock(lora);
+    if (!lora->sniff.active) {
+        // LoRa_stop_duty_cycled venceu a corrida com o cancelamento
+        next = 0;
+    } else if (!lora->sniff.listening) {
+        // Os registradores LoRa se mantêm em sleep; basta trocar o modo
+        lora->sniff.listening = true;
+        lora->sniff.windows++;
+        write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
+        next = -(int64_t)lora->sniff.rx_us;
+    } else if (rx_unread(lora) || (read_register(lora, REG_MODEM_STAT) & MODEM_STAT_SIGNAL_MASK)) {
+        lora->sniff.extended++;
+        next = -(int64_t)lora->sniff.rx_us;
+    } else {
+        lora->sniff.listening = false;
+        write_register(lora, REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_SLEEP);
+        next = -(int64_t)lora->sniff.sleep_us;
+    }
+    bus_unlock(lora, status);
+    return next;
+}
+
+// Estimativa para um par (rx_us, sleep_us) na configuração atual do modem:
+// corrente média, latência extra e preâmbulo mínimo dos transmissores
+void LoRa_duty_cycle_estimate(LoRa_t *lora, uint32_t rx_us, uint32_t sleep_us,
+                              LoRa_duty_cycle_estimate_t *estimate) {
+    uint32_t period = rx_us + sleep_us + WAKEUP_US;
+    estimate->average_current_ua = (CURRENT_RX_UA * rx_us + CURRENT_SLEEP_UA * sleep_us +
+                                    CURRENT_STDBY_UA * WAKEUP_US) / period;
+    estimate->latency_avg_us = period / 2;
+    estimate->latency_max_us = period;
+
+    // O preâmbulo precisa atravessar um período inteiro para cair numa janela
+    uint32_t symbol = symbol_time(lora);
+    uint64_t span_q8 = (uint64_t)period << 8;
+    estimate->preamble_length = (long)((span_q8 + symbol - 1) / symbol);
+    if (estimate->preamble_length < 8) estimate->preamble_length = 8;
+    estimate->preamble_overhead_us = LoRa_symbols_to_us(lora, estimate->preamble_length - 8);
+}
+
+// Calibração do SPI --------------------------------------------------------
+
+// Escrita/leitura de padrões direto no chip, sem passar pela shadow
+static bool spi_link_ok(LoRa_t *lora) {
+    static const uint8_t patterns[] = {0x00, 0xff, 0x55, 0xaa, 0x0f, 0xf0, 0x12, 0xed};
+    uint8_t fifo_out[16];
+    uint8_t fifo_in[16];
+
+    for (int round = 0; round < SPI_CALIBRATION_ROUNDS; round++) {
+        if (single_transfer(lora, REG_VERSION, 0x00) != 0x12) return false;
+
+        for (size_t i = 0; i < sizeof(patterns); i++) {
+            single_transfer(lora, REG_SYNC_WORD | 0x80, patterns[i]);
+            if (single_transfer(lora, REG_SYNC_WORD, 0x00) != patterns[i]) return false;
+        }
+
+        // Rajada pela FIFO, como nos pacotes
+        for (int i = 0; i < 16; i++) fifo_out[i] = patterns[(i + round) % sizeof(patterns)] ^ i;
+        single_transfer(lora, REG_FIFO_ADDR_PTR | 0x80, 0);
+        write_burst(lora, REG_FIFO, fifo_out, sizeof(fifo_out));
+        single_transfer(lora, REG_FIFO_ADDR_PTR | 0x80, 0);
+        read_burst(lora, REG_FIFO, fifo_in, sizeof(fifo_in));
+        dma_wait(lora);
+        if (memcmp(fifo_in, fifo_out, sizeof(fifo_in)) != 0) return false;
+    }
+    return true;
+}
+
+// Sobe o clock em passos de 1 MHz até max_frequency (no máximo 10 MHz) e
+// fica com o mais rápido que passou em todos os padrões. Chamar após
+// LoRa_begin com o rádio em standby; o conteúdo da FIFO é perdido.
+// Retorna o clock escolhido (o real do periférico), ou 0 se nem o atual passa.
+uint32_t LoRa_calibrate_spi(LoRa_t *lora, uint32_t max_frequency) {
+    if (max_frequency == 0 || max_frequency > SPI_MAX_FREQUENCY) max_frequency = SPI_MAX_FREQUENCY;
+
+    uint8_t sync_word = single_transfer(lora, REG_SYNC_WORD, 0x00);
+    uint32_t best = 0;
+    uint32_t actual = lora->spi_frequency;
+
+    if (spi_link_ok(lora)) {
+        best = actual;
+        for (uint32_t target = actual + SPI_CALIBRATION_STEP; target <= max_frequency; target += SPI_CALIBRATION_STEP) {
+            uint32_t rate = link_set_rate(lora, target);
+            if (rate <= best) continue;   // divisores do clk_peri: mesmo clock
+            if (!spi_link_ok(lora)) break;
+            best = rate;
+        }
+    }
+
+    link_set_rate(lora, best ? best : actual);
+    single_transfer(lora, REG_SYNC_WORD | 0x80, sync_word);
+    if (best) lora->spi_frequency = best;
+    return best;
+}
+
+// Serviço no core1 ----------------------------------------------------------
+
+// Deve ser chamado antes de LoRa_begin
+void LoRa_set_core1_service(LoRa_t *lora, bool enabled) {
+    lora->service.enabled = enabled;
+}
+
+// Chamado no core0: copia o pacote para a fila compartilhada e acorda o core1
+int LoRa_service_send(LoRa_t *lora, const uint8_t *buffer, size_t size) {
+    if (lora != service_lora) return 0;
+
+    uint32_t head = lora->service.head;
+    if (size > 255 || head - lora->service.tail == LORA_SERVICE_TX_SLOTS) {
+        // Os contadores são escritos nos dois núcleos: sempre sob o lock
+        uint32_t status = bus_lock(lora);
+        lora->service.stats.tx_rejected++;
+        bus_unlock(lora, status);
+        return 0;
+    }
+
+    memcpy(lora->service.slots[head % LORA_SERVICE_TX_SLOTS].data, buffer, size);
+    lora->service.slots[head % LORA_SERVICE_TX_SLOTS].length = size;
+    lora->service.slots[head % LORA_SERVICE_TX_SLOTS].queued_us = now_us(lora);
+    __dmb();
+    lora->service.head = head + 1;
+
+    multicore_fifo_push_blocking(SERVICE_CMD_TX);
+    return 1;
+}
+
+void LoRa_service_receive(LoRa_t *lora) {
+    if (lora != service_lora) return;
+    multicore_fifo_push_blocking(SERVICE_CMD_RECEIVE);
+}
+
+void LoRa_service_idle(LoRa_t *lora) {
+    if (lora != service_lora) return;
+    multicore_fifo_push_blocking(SERVICE_CMD_IDLE);
+}
+
+void LoRa_service_sleep(LoRa_t *lora) {
+    if (lora != service_lora) return;
+    multicore_fifo_push_blocking(SERVICE_CMD_SLEEP);
+}
+
+// Cópia consistente: o core1 atualiza os contadores sob o mesmo lock
+void LoRa_service_get_stats(LoRa_t *lora, LoRa_service_stats_t *stats) {
+    uint32_t status = bus_lock(lora);
+    *stats = lora->service.stats;
+    bus_unlock(lora, status);
+}
+
+static void service_main(void) {
+    LoRa_t *lora = service_lora;
+
+    // A IRQ de GPIO é por núcleo: o DIO0 passa a ser atendido aqui, e a
+    // IRQ de software que recebe o trabalho dela também
+    deferred_irq_init();
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    LoRa_receive(lora, 0);
+
+    while (true) {
+        LoRa_poll_events(lora);
+
+        while (multicore_fifo_rvalid()) {
+            service_command(lora, multicore_fifo_pop_blocking());
+        }
+
+        // Acorda com a IRQ do DIO0 ou com o __sev() do push na FIFO
+        if (lora->events.tail == lora->events.head && !multicore_fifo_rvalid()) {
+            __wfe();
+        }
+    }
+}
+
+static void service_command(LoRa_t *lora, uint32_t command) {
+    switch (command) {
+        case SERVICE_CMD_TX:
+            // Esvazia a fila inteira; cada TX bloqueia só o core1
+            while (lora->service.tail != lora->service.head) {
+                uint32_t tail = lora->service.tail;
+                __dmb();
+                uint64_t latency = now_us(lora) - lora->service.slots[tail % LORA_SERVICE_TX_SLOTS].queued_us;
+
+                LoRa_begin_packet(lora, lora->implicit_header_mode);
+                LoRa_write(lora, lora->service.slots[tail % LORA_SERVICE_TX_SLOTS].data,
+                           lora->service.slots[tail % LORA_SERVICE_TX_SLOTS].length);
+
+                // O slot só é liberado depois do TX: a rajada por DMA lê dele
+                bool sent = LoRa_end_packet(lora, false);
+                __dmb();
+                lora->service.tail = tail + 1;
+
+                uint32_t status = bus_lock(lora);
+                if (sent) {
+                    lora->service.stats.tx_sent++;
+                } else {
+                    lora->service.stats.tx_failed++;
+                }
+                lora->service.stats.tx_latency_sum_us += latency;
+                if (latency > lora->service.stats.tx_latency_max_us) {
+                    lora->service.stats.tx_latency_max_us = latency;
+                }
+                bus_unlock(lora, status);
+            }
+            LoRa_receive(lora, 0);
+            break;
+        case SERVICE_CMD_RECEIVE:
+            LoRa_receive(lora, 0);
+            break;
+        case SERVICE_CMD_IDLE:
+            LoRa_idle(lora);
+            break;
+        case SERVICE_CMD_SLEEP:
+            LoRa_sleep(lora);
+            break;
+    }
 }
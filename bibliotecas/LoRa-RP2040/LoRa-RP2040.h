@@ -8,8 +8,9 @@
 #include "pico/binary_info.h"
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
+#include "hardware/pio.h"
+#include "LoRa-RP2040-transport.h"
 #include "string.h"
-#include "Print.h"
 
 #define PIN_MISO 16
 #define PIN_CS   8
@@ -24,111 +25,262 @@
 #define LORA_DEFAULT_SS_PIN        8
 #define LORA_DEFAULT_RESET_PIN     9
 #define LORA_DEFAULT_DIO0_PIN      7
-#endif
 
 #define PA_OUTPUT_RFO_PIN          0
 #define PA_OUTPUT_PA_BOOST_PIN     1
 
-static void __empty();
-
-//class LoRaClass : public Stream {
-class LoRaClass : public Print {
-public:
-  LoRaClass();
-
-  int begin(long frequency);
-  void end();
-
-  int beginPacket(int implicitHeader = false);
-  int endPacket(bool async = false);
-
-  int parsePacket(int size = 0);
-  int packetRssi();
-  float packetSnr();
-  long packetFrequencyError();
-
-  int rssi();
-
-  // from Print
-  virtual size_t write(uint8_t byte);
-  virtual size_t write(const uint8_t *buffer, size_t size);
-
-  // from Stream
-  virtual int available();
-  virtual int read();
-  virtual int peek();
-  virtual void flush();
-
-  void onCadDone(void (*callback)(bool));
-  void onReceive(void (*callback)(int));
-  void onTxDone(void (*callback)());
-
-  void receive(int size = 0);
-  void channelActivityDetection(void);
-
-  void idle();
-  void sleep();
-
-  // size_t print(const char* c);
-
-  void setTxPower(int level, int outputPin = PA_OUTPUT_PA_BOOST_PIN);
-  void setFrequency(long frequency);
-  void setSpreadingFactor(int sf);
-  void setSignalBandwidth(long sbw);
-  void setCodingRate4(int denominator);
-  void setPreambleLength(long length);
-  void setSyncWord(int sw);
-  void enableCrc();
-  void disableCrc();
-  void enableInvertIQ();
-  void disableInvertIQ();
+// API em C (LoRa-RP2040.c)
 
-  void setOCP(uint8_t mA); // Over Current Protection control
-
-  void setGain(uint8_t gain); // Set LNA gain
-
-  // deprecated
-  void crc() { enableCrc(); }
-  void noCrc() { disableCrc(); }
-
-  uint8_t random();
-
-  void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN, int dio0 = LORA_DEFAULT_DIO0_PIN);
-  void setSPI(spi_inst_t &spi);
-  void setSPIFrequency(uint32_t frequency);
-
-  void dumpRegisters();
-
-private:
-  void explicitHeaderMode();
-  void implicitHeaderMode();
+// Número máximo de módulos SX127x operando ao mesmo tempo
+#ifndef LORA_MAX_INSTANCES
+#define LORA_MAX_INSTANCES         2
+#endif
 
-  void handleDio0Rise();
-  bool isTransmitting();
+// Quadros recebidos guardados pela fila de RX (ver LoRa_set_rx_queue)
+#ifndef LORA_RX_QUEUE_SLOTS
+#define LORA_RX_QUEUE_SLOTS        4
+#endif
 
-  int getSpreadingFactor();
-  long getSignalBandwidth();
+// Quadros na fila de TX em sequência (ver LoRa_tx_enqueue)
+#ifndef LORA_TX_QUEUE_SLOTS
+#define LORA_TX_QUEUE_SLOTS        4
+#endif
 
-  void setLdoFlag();
+// Expoente máximo do backoff do listen-before-talk (ver LoRa_set_lbt)
+#ifndef LORA_LBT_MAX_BACKOFF_EXP
+#define LORA_LBT_MAX_BACKOFF_EXP   6
+#endif
 
-  uint8_t readRegister(uint8_t address);
-  void writeRegister(uint8_t address, uint8_t value);
-  uint8_t singleTransfer(uint8_t address, uint8_t value);
+// Pares acompanhados pela AFC (ver LoRa_set_afc)
+#ifndef LORA_AFC_PEERS
+#define LORA_AFC_PEERS             8
+#endif
 
-  static void onDio0Rise(uint, uint32_t);
+// Pacotes aguardando o core1 no modo de serviço (ver LoRa_set_core1_service)
+#ifndef LORA_SERVICE_TX_SLOTS
+#define LORA_SERVICE_TX_SLOTS      4
+#endif
 
-private:
-  // SPISettings _spiSettings;
-  spi_inst_t *_spi;
-  int _ss;
-  int _reset;
-  int _dio0;
-  long _frequency;
-  int _packetIndex;
-  int _implicitHeaderMode;
-  void (*_onReceive)(int);
-  void (*_onCadDone)(bool);
-  void (*_onTxDone)();
-};
+// Handle de um rádio, obtido com LoRa_init
+typedef struct LoRa_s LoRa_t;
+
+// Quadro recebido com os metadados capturados no RxDone
+typedef struct {
+    uint8_t data[255];
+    uint8_t length;
+    uint8_t irq_flags;
+    int rssi;
+    float snr;
+    long frequency_error;      // Hz
+    uint64_t timestamp_us;     // borda do DIO0 (time_us_64)
+    uint64_t start_us;         // início estimado: timestamp_us - tempo no ar
+} LoRa_rx_frame_t;
+
+// Desempenho da fila de TX desde o último reset das estatísticas
+typedef struct {
+    uint32_t packets;
+    uint64_t elapsed_us;           // primeiro TX -> último TxDone
+    uint64_t airtime_us;
+    uint64_t idle_us;              // elapsed_us - airtime_us
+    uint32_t gap_max_us;           // TxDone -> próximo TX
+    uint32_t gap_avg_us;
+    float packets_per_second;
+} LoRa_tx_queue_stats_t;
+
+// Ocupação do canal vista pelo listen-before-talk
+typedef struct {
+    uint32_t cad_runs;
+    uint32_t cad_busy;             // CADs que detectaram preâmbulo
+    uint32_t backoffs;
+    uint32_t dropped;              // quadros descartados após max_attempts
+    uint64_t backoff_sum_us;
+} LoRa_lbt_stats_t;
+
+// Custo de um RX com ciclo de trabalho (ver LoRa_duty_cycle_estimate)
+typedef struct {
+    float average_current_ua;
+    uint32_t latency_avg_us;       // espera extra média até a próxima janela
+    uint32_t latency_max_us;
+    long preamble_length;          // símbolos que o transmissor deve usar
+    uint32_t preamble_overhead_us; // tempo no ar extra por pacote enviado
+} LoRa_duty_cycle_estimate_t;
+
+// Contadores do serviço no core1
+typedef struct {
+    uint32_t tx_sent;
+    uint32_t tx_failed;
+    uint32_t tx_rejected;          // fila cheia em LoRa_service_send
+    uint32_t tx_latency_max_us;    // LoRa_service_send -> início do TX
+    uint64_t tx_latency_sum_us;
+} LoRa_service_stats_t;
+
+// Configuração completa do modem, aplicada de uma vez por LoRa_apply_config
+typedef struct {
+    long frequency;
+    int spreading_factor;
+    long signal_bandwidth;
+    int coding_rate4;
+    long preamble_length;
+    int sync_word;
+    bool crc;
+    bool invert_iq;
+    int tx_power;
+} LoRa_config_t;
+
+// Retorna NULL quando as LORA_MAX_INSTANCES já estão em uso
+LoRa_t *LoRa_init(void);
+void LoRa_set_pins(LoRa_t *lora, int ss, int reset, int dio0);
+void LoRa_set_spi(LoRa_t *lora, spi_inst_t *spi, uint miso, uint sck, uint mosi);
+// Alternativa ao SPI de hardware: SPI em PIO com CS na state machine
+// (usa o pino ss de LoRa_set_pins; incompatível com LoRa_enable_dma)
+void LoRa_set_pio(LoRa_t *lora, PIO pio, uint miso, uint sck, uint mosi);
+// Transporte alternativo (por exemplo LoRa_sim_transport); antes de LoRa_begin
+void LoRa_set_transport(LoRa_t *lora, const LoRa_transport_t *transport, void *context);
+// Retorna 0 se o rádio não responde, se o DIO0 não é um pino do banco 0
+// (0..29) ou se ele já pertence a outra instância (ver LoRa_end)
+int LoRa_begin(LoRa_t *lora, long frequency);
+// Para tudo o que roda em segundo plano (fila de TX, LBT, TX agendado, RX
+// com ciclo de trabalho) e põe o rádio em sleep; sem efeito no modo de serviço
+void LoRa_end(LoRa_t *lora);
+
+// Clock do SPI (padrão LORA_DEFAULT_SPI_FREQUENCY); a calibração procura o
+// mais rápido que a placa aguenta, até 10 MHz
+void LoRa_set_spi_frequency(LoRa_t *lora, uint32_t frequency);
+uint32_t LoRa_get_spi_frequency(LoRa_t *lora);
+uint32_t LoRa_calibrate_spi(LoRa_t *lora, uint32_t max_frequency);
+
+int LoRa_begin_packet(LoRa_t *lora, int implicit_header);
+int LoRa_end_packet(LoRa_t *lora, bool async);
+bool LoRa_is_transmitting(LoRa_t *lora);
+size_t LoRa_write(LoRa_t *lora, const uint8_t *buffer, size_t size);
+
+int LoRa_parse_packet(LoRa_t *lora, int size);
+int LoRa_packet_rssi(LoRa_t *lora);
+float LoRa_packet_snr(LoRa_t *lora);
+long LoRa_packet_frequency_error(LoRa_t *lora);
+int LoRa_available(LoRa_t *lora);
+int LoRa_read(LoRa_t *lora);
+size_t LoRa_read_buffer(LoRa_t *lora, uint8_t *dst, size_t len);
+void LoRa_receive(LoRa_t *lora, int size);
+
+void LoRa_idle(LoRa_t *lora);
+void LoRa_sleep(LoRa_t *lora);
+
+void LoRa_set_tx_power(LoRa_t *lora, int level);
+void LoRa_set_frequency(LoRa_t *lora, long frequency);
+void LoRa_set_spreading_factor(LoRa_t *lora, int sf);
+int LoRa_get_spreading_factor(LoRa_t *lora);
+void LoRa_set_signal_bandwidth(LoRa_t *lora, long sbw);
+long LoRa_get_signal_bandwidth(LoRa_t *lora);
+void LoRa_set_coding_rate4(LoRa_t *lora, int denominator);
+void LoRa_set_preamble_length(LoRa_t *lora, long length);
+void LoRa_set_sync_word(LoRa_t *lora, int sw);
+void LoRa_enable_crc(LoRa_t *lora);
+void LoRa_disable_crc(LoRa_t *lora);
+void LoRa_enable_invert_iq(LoRa_t *lora);
+void LoRa_disable_invert_iq(LoRa_t *lora);
+void LoRa_explicit_header_mode(LoRa_t *lora);
+void LoRa_implicit_header_mode(LoRa_t *lora);
+void LoRa_apply_config(LoRa_t *lora, const LoRa_config_t *config);
+
+void LoRa_invalidate_shadow(LoRa_t *lora);
+int LoRa_verify_shadow(LoRa_t *lora);
+
+// Com o DMA ativo, LoRa_write e LoRa_read_buffer retornam antes do fim da
+// rajada: o buffer precisa continuar válido até on_done ser chamado.
+// on_done roda na IRQ do DMA (ou no acesso ao SPI que precisou esperar a
+// rajada), depois que o CS subiu e um TX adiado já foi disparado.
+bool LoRa_enable_dma(LoRa_t *lora, void (*on_done)(LoRa_t *lora));
+void LoRa_disable_dma(LoRa_t *lora);
+bool LoRa_dma_busy(LoRa_t *lora);
+
+// Os callbacks on_receive/on_tx_done/on_cad_done rodam dentro de LoRa_poll_events
+void LoRa_set_on_receive(LoRa_t *lora, void (*callback)(LoRa_t *lora, int size));
+void LoRa_set_on_tx_done(LoRa_t *lora, void (*callback)(LoRa_t *lora));
+void LoRa_set_on_cad_done(LoRa_t *lora, void (*callback)(LoRa_t *lora, bool detected));
+// Retorna 0 (sem CAD) com a fila de TX ativa
+int LoRa_channel_activity_detection(LoRa_t *lora);
+int LoRa_poll_events(LoRa_t *lora);
+uint32_t LoRa_events_dropped(LoRa_t *lora);
+
+// Com a fila ativa cada quadro é copiado para um slot já no RxDone (não
+// depende de LoRa_poll_events); a aplicação consome no seu ritmo com
+// LoRa_rx_pop. Fila cheia descarta o quadro e conta em LoRa_rx_overflows.
+// A cópia roda na mesma IRQ de software da fila de TX, não na do GPIO, e
+// mascara as IRQs pela leitura inteira: flags, tamanho, a rajada da FIFO
+// (esperada até o fim mesmo com DMA) e RSSI, SNR e erro de frequência,
+// cerca de tamanho + 21 bytes de SPI (~220 us para 255 bytes a 10 MHz).
+void LoRa_set_rx_queue(LoRa_t *lora, bool enabled);
+bool LoRa_rx_pop(LoRa_t *lora, LoRa_rx_frame_t *frame);
+uint32_t LoRa_rx_overflows(LoRa_t *lora);
+
+// Carimbos de tempo (time_us_64) do último RxDone/TxDone, capturados na borda
+// do DIO0, e o início do quadro estimado pelo tempo no ar
+uint64_t LoRa_rx_done_us(LoRa_t *lora);
+uint64_t LoRa_rx_start_us(LoRa_t *lora);
+uint64_t LoRa_tx_done_us(LoRa_t *lora);
+uint64_t LoRa_tx_start_us(LoRa_t *lora);
+// Tempo no ar e duração de símbolos saturam em UINT32_MAX (~71 min)
+uint32_t LoRa_time_on_air_us(LoRa_t *lora, int payload_length);
+uint32_t LoRa_symbols_to_us(LoRa_t *lora, uint32_t symbols);
+
+// Transmite o pacote montado em um instante absoluto via alarme de hardware
+int LoRa_schedule_tx(LoRa_t *lora, uint64_t at_us);
+void LoRa_cancel_scheduled_tx(LoRa_t *lora);
+
+// Fila de TX: cada TxDone recarrega a FIFO com o próximo quadro sem passar
+// por LoRa_poll_events. A IRQ do GPIO só carimba a borda e pendura uma IRQ
+// de software de prioridade mínima (user_irq_claim_unused, reservada em
+// LoRa_begin); a recarga roda nela, depois de todas as outras IRQs. Cada
+// transação SPI do driver roda sob um lock do barramento, então a recarga
+// nunca interrompe uma transação em curso no laço principal ou no outro
+// núcleo. Pior caso com as IRQs mascaradas: a recarga inteira, cerca de
+// tamanho + 11 bytes de SPI no modo bloqueante (~215 us para 255 bytes a
+// 10 MHz), mais o resto de uma rajada de DMA que já estivesse em curso; com
+// DMA a FIFO é carregada em segundo plano e sobram duas transações de um
+// registrador e a partida da rajada. Sem IRQ de usuário livre a recarga
+// roda na própria IRQ do GPIO.
+int LoRa_tx_enqueue(LoRa_t *lora, const uint8_t *buffer, size_t size);
+int LoRa_tx_queue_pending(LoRa_t *lora);
+void LoRa_tx_queue_get_stats(LoRa_t *lora, LoRa_tx_queue_stats_t *stats);
+void LoRa_tx_queue_reset_stats(LoRa_t *lora);
+// Esvazia a fila, cancela o backoff do LBT e põe o rádio em standby
+int LoRa_tx_queue_flush(LoRa_t *lora);
+
+// Listen-before-talk: cada quadro da fila de TX passa por um CAD antes de
+// sair; canal ocupado gera backoff exponencial aleatório por alarme
+void LoRa_set_lbt(LoRa_t *lora, bool enabled, uint32_t slot_us, uint8_t max_attempts);
+void LoRa_lbt_get_stats(LoRa_t *lora, LoRa_lbt_stats_t *stats);
+void LoRa_lbt_reset_stats(LoRa_t *lora);
+
+// AFC por par: a aplicação informa o erro medido de cada remetente e chama
+// LoRa_afc_retune antes de transmitir para ele. shift (máximo 16) é o peso
+// das novas medidas: média móvel exponencial com alfa = 1 / 2^shift.
+void LoRa_set_afc(LoRa_t *lora, bool enabled, uint8_t shift);
+void LoRa_afc_observe(LoRa_t *lora, uint32_t peer, long frequency_error);
+long LoRa_afc_offset(LoRa_t *lora, uint32_t peer);
+void LoRa_afc_retune(LoRa_t *lora, uint32_t peer);
+void LoRa_afc_restore(LoRa_t *lora);
+
+// RX com ciclo de trabalho: janelas de rx_us em RX separadas por sleep_us em
+// sleep, comandadas por alarme de hardware. A janela só fecha depois que o
+// pacote recebido foi lido por inteiro (ou copiado pela fila de RX).
+int LoRa_receive_duty_cycled(LoRa_t *lora, uint32_t rx_us, uint32_t sleep_us);
+// Cancela o alarme e deixa o rádio em standby
+void LoRa_stop_duty_cycled(LoRa_t *lora);
+void LoRa_duty_cycle_estimate(LoRa_t *lora, uint32_t rx_us, uint32_t sleep_us,
+                              LoRa_duty_cycle_estimate_t *estimate);
+
+// Modo de serviço: LoRa_begin lança o core1, que passa a ser o dono do SPI e
+// do DIO0. O core0 só usa as funções abaixo e LoRa_rx_pop para os quadros
+// recebidos; as demais funções não devem mais ser chamadas no core0.
+// Só um rádio por vez pode estar no modo de serviço: o LoRa_begin de um
+// segundo falha e LoRa_service_* ignoram qualquer outro rádio (send retorna 0).
+void LoRa_set_core1_service(LoRa_t *lora, bool enabled);
+int LoRa_service_send(LoRa_t *lora, const uint8_t *buffer, size_t size);
+void LoRa_service_receive(LoRa_t *lora);
+void LoRa_service_idle(LoRa_t *lora);
+void LoRa_service_sleep(LoRa_t *lora);
+void LoRa_service_get_stats(LoRa_t *lora, LoRa_service_stats_t *stats);
 
-extern LoRaClass LoRa;
+#endif
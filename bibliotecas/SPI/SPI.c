@@ -1,6 +1,7 @@
 #include "SPI.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 
 #define SPI_PORT spi0
 #define PIN_MISO 16
@@ -8,6 +9,13 @@
 #define PIN_SCK  18
 #define PIN_MOSI 19
 
+// Abaixo disso configurar o DMA custa mais que copiar pela CPU
+#define SPI_DMA_THRESHOLD 16
+
+static int dma_tx = -1;
+static int dma_rx = -1;
+static uint8_t dma_dummy;
+
 void SPI_init() {
     spi_init(SPI_PORT, 500 * 1000);
     gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
@@ -24,3 +32,58 @@ uint8_t SPI_transfer(uint8_t data) {
     spi_write_read_blocking(SPI_PORT, &data, &rx, 1);
     return rx;
 }
+
+void SPI_transfer_buffer(const uint8_t *tx, uint8_t *rx, size_t len) {
+    if (len == 0) return;
+
+    if (dma_tx < 0 || len < SPI_DMA_THRESHOLD) {
+        if (tx && rx) {
+            spi_write_read_blocking(SPI_PORT, tx, rx, len);
+        } else if (tx) {
+            spi_write_blocking(SPI_PORT, tx, len);
+        } else if (rx) {
+            spi_read_blocking(SPI_PORT, 0x00, rx, len);
+        } else {
+            // Só clock: os bytes lidos vão para um descarte
+            uint8_t dummy;
+            for (size_t i = 0; i < len; i++) spi_read_blocking(SPI_PORT, 0x00, &dummy, 1);
+        }
+        return;
+    }
+
+    // Canal de RX sempre ativo para esvaziar a FIFO do SPI
+    dma_dummy = 0x00;
+    dma_channel_config c = dma_channel_get_default_config(dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, true));
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(dma_tx, &c, &spi_get_hw(SPI_PORT)->dr,
+                          tx ? (const void *)tx : (const void *)&dma_dummy, len, false);
+
+    c = dma_channel_get_default_config(dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    dma_channel_configure(dma_rx, &c, rx ? (void *)rx : (void *)&dma_dummy,
+                          &spi_get_hw(SPI_PORT)->dr, len, false);
+
+    dma_start_channel_mask((1u << dma_tx) | (1u << dma_rx));
+    dma_channel_wait_for_finish_blocking(dma_rx);
+}
+
+bool SPI_enable_dma() {
+    if (dma_tx >= 0) return true;
+
+    int tx = dma_claim_unused_channel(false);
+    int rx = dma_claim_unused_channel(false);
+    if (tx < 0 || rx < 0) {
+        if (tx >= 0) dma_channel_unclaim(tx);
+        if (rx >= 0) dma_channel_unclaim(rx);
+        return false;
+    }
+    dma_tx = tx;
+    dma_rx = rx;
+    return true;
+}
@@ -2,8 +2,17 @@
 #define SPI_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 void SPI_init();
 uint8_t SPI_transfer(uint8_t data);
 
+// Transfere len bytes numa única chamada. tx NULL envia zeros e rx NULL
+// descarta o que chega. O CS continua por conta de quem chama.
+void SPI_transfer_buffer(const uint8_t *tx, uint8_t *rx, size_t len);
+
+// Blocos a partir de SPI_DMA_THRESHOLD bytes passam a usar DMA
+bool SPI_enable_dma();
+
 #endif
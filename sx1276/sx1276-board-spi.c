@@ -0,0 +1,22 @@
+/*!
+ * \file      sx1276-board-spi.c
+ *
+ * \brief     SX1276 block SPI transfers over the RP2040 SPI library
+ *
+ * \remark    Overrides the weak SpiInOutBuffer of sx1276.c with a single
+ *            SPI_transfer_buffer call per block. The board SpiInOut must
+ *            drive the same port, through SPI_transfer, since the address
+ *            byte and the block share one NSS cycle.
+ *
+ * \remark    Calling SPI_enable_dma once at start-up moves the blocks of
+ *            16 bytes and more (FIFO accesses) to DMA.
+ */
+#include "spi.h"
+#include "SPI.h"
+
+void SpiInOutBuffer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size )
+{
+    ( void )obj;
+
+    SPI_transfer_buffer( txBuffer, rxBuffer, size );
+}
@@ -51,6 +51,12 @@
  */
 #define RX_TX_BUFFER_SIZE                           256
 
+/*!
+ * Temperature monitor time in the synthesizer mode before the sensor is read.
+ * The calibration timer ticks every millisecond: 2 ms guarantee a full one.
+ */
+#define SX1276_TEMPERATURE_SAMPLE_TIME              2 // [ms]
+
 /*
  * Local types definition
  */
@@ -65,6 +71,17 @@ typedef struct
     uint8_t       Value;
 }RadioRegisters_t;
 
+/*!
+ * Contiguous registers written with a single SPI burst
+ */
+typedef struct
+{
+    RadioModems_t Modem;
+    uint8_t       Addr;
+    uint8_t       Size;
+    uint8_t       Offset;           //!< First value in RadioRegsInitValues
+}RadioRegistersRun_t;
+
 /*!
  * FSK bandwidth definition
  */
@@ -74,6 +91,65 @@ typedef struct
     uint8_t  RegValue;
 }FskBandwidth_t;
 
+/*!
+ * LoRa time-on-air constants of a bandwidth / spreading factor pair
+ *
+ * \remark The payload is coded in blocks of BitsPerBlock bits, each block
+ *         costing ( 4 + coderate ) symbols. A quarter symbol lasts
+ *         2^QuarterSymbolShift us, so time-on-air reduces to a reciprocal
+ *         multiply, a multiply-add and a shift.
+ */
+typedef struct
+{
+    uint8_t  BitsPerBlock;          //!< 4 * ( SF - 2 * LowDatarateOptimize )
+    uint8_t  QuarterSymbolShift;    //!< log2( 2^SF / ( 4 * bandwidth ) ) [us]
+    uint32_t BlockReciprocal;       //!< ceil( 2^20 / BitsPerBlock )
+}LoRaTimeOnAir_t;
+
+/*!
+ * Rx chain calibration steps
+ */
+typedef enum
+{
+    CALIBRATION_IDLE = 0,
+    CALIBRATION_LF_RUNNING,
+    CALIBRATION_HF_RUNNING,
+    CALIBRATION_TEMP_RUNNING,           //!< Temperature reading that ends a calibration
+    CALIBRATION_TEMP_CHECK,             //!< Temperature reading of SX1276CheckCalibration
+}CalibrationStep_t;
+
+/*!
+ * Rx chain calibration context
+ */
+typedef struct
+{
+    CalibrationStep_t Step;
+    TimerTime_t       StartTime;        //!< Start of the whole calibration
+    TimerTime_t       StepTime;         //!< Start of the current band calibration
+    uint8_t           RegPaConfig;      //!< Saved context
+    uint32_t          Frequency;        //!< Saved context
+    RadioModems_t     Modem;            //!< Saved context
+    int8_t            Threshold;        //!< SX1276CheckCalibration temperature threshold
+    bool              InitPending;      //!< SX1276InitAsync waits for the calibration
+    bool              SkipTemperature;  //!< Blocking calibration: no reference temperature read
+    void           ( *OnDone )( bool success );
+}CalibrationContext_t;
+
+/*!
+ * Asynchronous carrier sense context
+ */
+typedef struct
+{
+    bool              Running;
+    uint8_t           NbChannels;
+    uint8_t           Channel;          //!< Channel being sensed
+    int16_t           RssiThresh;
+    uint32_t          SenseTime;        //!< Per channel [ms]
+    TimerTime_t       ChannelStart;     //!< First sample of the current channel
+    int64_t           RssiSum;
+    void           ( *OnDone )( SX1276CarrierSenseResult_t *results, uint8_t nbChannels );
+}CarrierSenseContext_t;
+
 
 /*
  * Private functions prototypes
@@ -83,9 +159,77 @@ typedef struct
  * Performs the Rx chain calibration for LF and HF bands
  * \remark Must be called just after the reset so all registers are at their
  *         default values
+ * \remark Blocks until both bands are calibrated or
+ *         SX1276_CALIBRATION_TIMEOUT expired
  */
 static void RxChainCalibration( void );
 
+/*!
+ * \brief Saves the context and launches the LF band image calibration
+ *
+ * \remark The radio must be in FSK standby mode
+ */
+static void RxChainCalibrationStart( void );
+
+/*!
+ * \brief Advances the Rx chain calibration state machine without blocking
+ *
+ * \retval finished true once both bands are calibrated or a step timed out
+ */
+static bool RxChainCalibrationProcess( void );
+
+/*!
+ * \brief Turns the temperature monitor on
+ *
+ * \remark The radio must be in FSK standby mode. The sensor needs
+ *         SX1276_TEMPERATURE_SAMPLE_TIME before SX1276TemperatureSample.
+ */
+static void SX1276TemperatureStart( void );
+
+/*!
+ * \brief Turns the temperature monitor off and reads the die temperature
+ *
+ * \remark Leaves the radio in FSK standby mode. The value is uncalibrated:
+ *         only differences between two readings are meaningful.
+ *
+ * \retval temperature Temperature [°C]
+ */
+static int8_t SX1276TemperatureSample( void );
+
+/*!
+ * \brief Ends the calibration and restores the saved modem
+ *
+ * \retval finished Always true
+ */
+static bool RxChainCalibrationDone( void );
+
+/*!
+ * \brief Second half of the radio initialization, run once the Rx chain is
+ *        calibrated
+ */
+static void SX1276InitRegisters( void );
+
+/*!
+ * \brief Sorts RadioRegsInit by modem and address and splits it into burst
+ *        runs
+ *
+ * \remark Entries that interact with a modem switch (see
+ *         SX1276IsOrderedRegister) are barriers: they keep their place in
+ *         the table and only the entries between two barriers are sorted.
+ *         The register image is then the same as writing the table entry
+ *         by entry with a SX1276SetModem before each one.
+ */
+static void SX1276BuildRegistersInit( void );
+
+/*!
+ * \brief Writes the radio registers initialization table
+ *
+ * \remark One modem switch per modem between two barriers and one SPI
+ *         transaction per run of contiguous registers. Leaves the radio in
+ *         FSK mode.
+ */
+static void SX1276WriteRegistersInit( void );
+
 /*!
  * \brief Sets the SX1276 in transmission mode for the given time
  * \param [IN] timeout Transmission timeout [ms] [0: continuous, others timeout]
@@ -108,6 +252,20 @@ static void SX1276WriteFifo( uint8_t *buffer, uint8_t size );
  */
 static void SX1276ReadFifo( uint8_t *buffer, uint8_t size );
 
+/*!
+ * \brief Block SPI transfer used by the buffer/FIFO accessors
+ *
+ * \remark Weak default built on SpiInOut. sx1276-board-spi.c overrides it
+ *         with SPI_transfer_buffer from bibliotecas/SPI, DMA-backed after
+ *         SPI_enable_dma.
+ *
+ * \param [IN]  obj      SPI object
+ * \param [IN]  txBuffer Bytes to send [NULL: send zeros]
+ * \param [OUT] rxBuffer Received bytes [NULL: discard]
+ * \param [IN]  size     Number of bytes to transfer
+ */
+void SpiInOutBuffer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size );
+
 /*!
  * \brief Sets the SX1276 operating mode
  *
@@ -142,15 +300,6 @@ static uint32_t SX1276ConvertFreqInHzToPllStep( uint32_t freqInHz );
  */
 static uint8_t GetFskBandwidthRegValue( uint32_t bw );
 
-/*!
- * \brief Get the actual value in Hertz of a given LoRa bandwidth
- *
- * \param [in] bw LoRa bandwidth parameter
- *
- * \returns Actual LoRa bandwidth in Hertz
- */
-static uint32_t SX1276GetLoRaBandwidthInHz( uint32_t bw );
-
 /*!
  * Compute the numerator for GFSK time-on-air computation.
  *
@@ -168,21 +317,19 @@ static uint32_t SX1276GetGfskTimeOnAirNumerator( uint16_t preambleLen, bool fixL
                                                  uint8_t payloadLen, bool crcOn );
 
 /*!
- * Compute the numerator for LoRa time-on-air computation.
- *
- * \remark To get the actual time-on-air in second, this value has to be divided by the LoRa bandwidth in Hertz.
+ * Compute the LoRa time-on-air from the precomputed constants
  *
- * \param [in] bandwidth 
- * \param [in] datarate 
- * \param [in] coderate 
- * \param [in] preambleLen 
- * \param [in] fixLen 
- * \param [in] payloadLen 
- * \param [in] crcOn 
+ * \param [in] toa         Constants of the bandwidth / spreading factor pair
+ * \param [in] datarate    Spreading factor [5..12]
+ * \param [in] coderate
+ * \param [in] preambleLen
+ * \param [in] fixLen
+ * \param [in] payloadLen
+ * \param [in] crcOn
  *
- * \returns LoRa time-on-air numerator
+ * \returns LoRa time-on-air in ms, rounded up
  */
-static uint32_t SX1276GetLoRaTimeOnAirNumerator( uint32_t bandwidth,
+static uint32_t SX1276GetLoRaTimeOnAir( const LoRaTimeOnAir_t *toa,
                               uint32_t datarate, uint8_t coderate,
                               uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
                               bool crcOn );
@@ -221,6 +368,50 @@ static void SX1276OnDio4Irq( void* context );
  */
 static void SX1276OnTimeoutIrq( void* context );
 
+/*!
+ * \brief Calibration polling timer callback
+ */
+static void SX1276OnCalibrationTimerIrq( void* context );
+
+/*!
+ * \brief Carrier sense sampling timer callback
+ */
+static void SX1276OnCarrierSenseTimerIrq( void* context );
+
+/*!
+ * \brief Returns the buffer the current reception is read into
+ *
+ * \remark Acquires a free pool slot on the first call of a packet. When the
+ *         pool is exhausted the packet is dropped and counted in
+ *         SX1276RxPoolStats_t.Exhausted.
+ *
+ * \retval buffer Reception buffer [NULL: packet dropped]
+ */
+static uint8_t *SX1276RxBufferGet( void );
+
+/*!
+ * \brief Reads size bytes of the current FSK reception at offset
+ *
+ * \remark A dropped packet is still drained from the FIFO and discarded.
+ *         offset 0 starts a new packet.
+ */
+static void SX1276ReadRxFifo( uint8_t offset, uint8_t size );
+
+/*!
+ * \brief Hands the current reception to RadioEvents->RxDone
+ *
+ * \remark A dropped packet is reported through RadioEvents->RxError.
+ */
+static void SX1276RxDeliver( uint16_t size, int16_t rssi, int8_t snr );
+
+/*!
+ * \brief Drops the driver reference to the current reception buffer
+ *
+ * \remark Called once RadioEvents->RxDone returned. The slot is recycled
+ *         unless the upper layer retained it.
+ */
+static void SX1276RxBufferHandOff( void );
+
 /*
  * Private global constants
  */
@@ -232,12 +423,46 @@ static void SX1276OnTimeoutIrq( void* context );
  */
 const RadioRegisters_t RadioRegsInit[] = RADIO_INIT_REGISTERS_VALUE;
 
+/*!
+ * Number of entries of the radio registers initialization table
+ */
+#define RADIO_REGS_INIT_COUNT                       ( sizeof( RadioRegsInit ) / sizeof( RadioRegisters_t ) )
+
 /*!
  * Constant values need to compute the RSSI value
  */
 #define RSSI_OFFSET_LF                              -164
 #define RSSI_OFFSET_HF                              -157
 
+/*!
+ * LoRa time-on-air table entry. Low datarate optimize is used for symbols
+ * longer than 16 ms ( SF11/SF12 @ 125 kHz, SF12 @ 250 kHz )
+ */
+#define LORA_TOA_ENTRY( bw, sf )                                                            \
+    {                                                                                       \
+        4 * ( ( sf ) - ( ( ( ( sf ) - ( bw ) ) >= 11 ) ? 2 : 0 ) ),                         \
+        ( sf ) + 1 - ( bw ),                                                                \
+        ( ( 1UL << 20 ) + 4 * ( ( sf ) - ( ( ( ( sf ) - ( bw ) ) >= 11 ) ? 2 : 0 ) ) - 1 ) /  \
+            ( 4 * ( ( sf ) - ( ( ( ( sf ) - ( bw ) ) >= 11 ) ? 2 : 0 ) ) )                  \
+    }
+
+#define LORA_TOA_ROW( bw )                                                                  \
+    {                                                                                       \
+        LORA_TOA_ENTRY( bw, 5 ), LORA_TOA_ENTRY( bw, 6 ), LORA_TOA_ENTRY( bw, 7 ),          \
+        LORA_TOA_ENTRY( bw, 8 ), LORA_TOA_ENTRY( bw, 9 ), LORA_TOA_ENTRY( bw, 10 ),         \
+        LORA_TOA_ENTRY( bw, 11 ), LORA_TOA_ENTRY( bw, 12 )                                  \
+    }
+
+/*!
+ * Precomputed LoRa time-on-air constants [bandwidth][datarate - 5]
+ */
+static const LoRaTimeOnAir_t LoRaTimeOnAirTable[3][SX1276_LORA_DATARATE_COUNT] =
+{
+    LORA_TOA_ROW( 0 ), // 125 kHz
+    LORA_TOA_ROW( 1 ), // 250 kHz
+    LORA_TOA_ROW( 2 ), // 500 kHz
+};
+
 /*!
  * Precomputed FSK bandwidth registers values
  */
@@ -277,9 +502,68 @@ const FskBandwidth_t FskBandwidths[] =
 static RadioEvents_t *RadioEvents;
 
 /*!
- * Reception buffer
+ * Transmission buffer used to send FSK payloads larger than the FIFO
+ */
+static uint8_t TxBuffer[RX_TX_BUFFER_SIZE];
+
+/*!
+ * Reference counted reception buffer
+ */
+typedef struct
+{
+    uint8_t          Buffer[RX_TX_BUFFER_SIZE];
+    volatile uint8_t RefCount;
+}RxFrame_t;
+
+/*!
+ * Reception buffer pool. The DIO handlers read the FIFO straight into a slot
+ * which is then lent to RadioEvents->RxDone
+ */
+static RxFrame_t RxPool[SX1276_RX_POOL_SIZE];
+
+/*!
+ * Slot being filled by the current reception [NULL: none]
+ */
+static RxFrame_t *RxFrame = NULL;
+
+/*!
+ * Buffer being filled by the current reception [NULL: none]
+ */
+static uint8_t *RxBuffer = NULL;
+
+/*!
+ * The current reception found the pool exhausted and is being dropped
+ */
+static bool RxDropping = false;
+
+/*!
+ * RxFrame is complete and being handed to RadioEvents->RxDone
+ */
+static bool RxDelivering = false;
+
+/*!
+ * Reception buffer pool statistics
+ */
+static SX1276RxPoolStats_t RxPoolStats;
+
+/*!
+ * RadioRegsInit grouped into burst runs [RadioRegsInitRunCount == 0: not built]
  */
-static uint8_t RxTxBuffer[RX_TX_BUFFER_SIZE];
+static RadioRegistersRun_t RadioRegsInitRuns[RADIO_REGS_INIT_COUNT];
+static uint8_t RadioRegsInitValues[RADIO_REGS_INIT_COUNT];
+static uint8_t RadioRegsInitRunCount = 0;
+
+/*!
+ * Rx chain calibration state and results
+ */
+static CalibrationContext_t Calibration;
+static SX1276CalibrationInfo_t CalibrationInfo;
+
+/*!
+ * Asynchronous carrier sense state and per channel results
+ */
+static CarrierSenseContext_t CarrierSense;
+static SX1276CarrierSenseResult_t CarrierSenseResults[SX1276_CARRIER_SENSE_MAX_CHANNELS];
 
 /*
  * Public global variables
@@ -304,42 +588,207 @@ TimerEvent_t TxTimeoutTimer;
 TimerEvent_t RxTimeoutTimer;
 TimerEvent_t RxTimeoutSyncWord;
 
+/*!
+ * Polls the image calibration status while it runs asynchronously
+ */
+TimerEvent_t CalibrationTimer;
+
+/*!
+ * Samples the RSSI during an asynchronous carrier sense
+ */
+TimerEvent_t CarrierSenseTimer;
+
 /*
  * Radio driver functions implementation
  */
 
 void SX1276Init( RadioEvents_t *events )
 {
-    uint8_t i;
-
     RadioEvents = events;
 
     // Initialize driver timeout timers
     TimerInit( &TxTimeoutTimer, SX1276OnTimeoutIrq );
     TimerInit( &RxTimeoutTimer, SX1276OnTimeoutIrq );
     TimerInit( &RxTimeoutSyncWord, SX1276OnTimeoutIrq );
+    TimerInit( &CalibrationTimer, SX1276OnCalibrationTimerIrq );
+    TimerInit( &CarrierSenseTimer, SX1276OnCarrierSenseTimerIrq );
 
     SX1276Reset( );
 
     RxChainCalibration( );
 
+    SX1276InitRegisters( );
+}
+
+void SX1276InitAsync( RadioEvents_t *events, void ( *onReady )( bool calibrated ) )
+{
+    RadioEvents = events;
+
+    // Initialize driver timeout timers
+    TimerInit( &TxTimeoutTimer, SX1276OnTimeoutIrq );
+    TimerInit( &RxTimeoutTimer, SX1276OnTimeoutIrq );
+    TimerInit( &RxTimeoutSyncWord, SX1276OnTimeoutIrq );
+    TimerInit( &CalibrationTimer, SX1276OnCalibrationTimerIrq );
+    TimerInit( &CarrierSenseTimer, SX1276OnCarrierSenseTimerIrq );
+
+    SX1276Reset( );
+
+    // The registers initialization is completed by the calibration timer
+    Calibration.InitPending = true;
+    Calibration.OnDone = onReady;
+    RxChainCalibrationStart( );
+    TimerSetValue( &CalibrationTimer, 1 );
+    TimerStart( &CalibrationTimer );
+}
+
+static void SX1276InitRegisters( void )
+{
     SX1276SetOpMode( RF_OPMODE_SLEEP );
 
     SX1276IoIrqInit( DioIrq );
 
-    for( i = 0; i < sizeof( RadioRegsInit ) / sizeof( RadioRegisters_t ); i++ )
+    SX1276WriteRegistersInit( );
+
+    SX1276.Settings.State = RF_IDLE;
+}
+
+static bool SX1276IsSharedRegister( uint8_t addr )
+{
+    // OpMode, Frf, PaConfig, PaRamp, Ocp, Lna and the 0x40..0x7F page are
+    // common to both modems
+    return ( addr == REG_OPMODE ) || ( ( addr >= REG_FRFMSB ) && ( addr <= REG_LNA ) ) || ( addr >= REG_DIOMAPPING1 );
+}
+
+static bool SX1276IsOrderedRegister( const RadioRegisters_t *reg )
+{
+    // SX1276SetModem writes OpMode and the DIO mappings: moving these across
+    // a modem switch changes their final value. A common register declared
+    // for LoRa forces a switch that the FSK page would not.
+    return ( reg->Addr == REG_OPMODE ) || ( reg->Addr == REG_DIOMAPPING1 ) || ( reg->Addr == REG_DIOMAPPING2 ) ||
+           ( ( reg->Modem == MODEM_LORA ) && ( SX1276IsSharedRegister( reg->Addr ) == true ) );
+}
+
+static uint16_t SX1276RegisterInitKey( const RadioRegisters_t *reg )
+{
+    // LoRa registers first so that the table ends in FSK mode
+    return ( ( reg->Modem == MODEM_LORA ) ? 0x0000 : 0x0100 ) | reg->Addr;
+}
+
+static void SX1276AppendRegisterInit( const RadioRegisters_t *reg )
+{
+    RadioRegistersRun_t *run = NULL;
+    uint8_t offset = 0;
+
+    if( RadioRegsInitRunCount > 0 )
     {
-        SX1276SetModem( RadioRegsInit[i].Modem );
-        SX1276Write( RadioRegsInit[i].Addr, RadioRegsInit[i].Value );
+        run = &RadioRegsInitRuns[RadioRegsInitRunCount - 1];
+        offset = run->Offset + run->Size;
     }
+    RadioRegsInitValues[offset] = reg->Value;
 
-    SX1276SetModem( MODEM_FSK );
+    // The FIFO address does not auto-increment and an OpMode write may
+    // switch the register page
+    if( ( run != NULL ) && ( run->Modem == reg->Modem ) && ( run->Addr != REG_FIFO ) &&
+        ( run->Addr != REG_OPMODE ) && ( ( run->Addr + run->Size ) == reg->Addr ) )
+    {
+        run->Size++;
+        return;
+    }
+    run = &RadioRegsInitRuns[RadioRegsInitRunCount++];
+    run->Modem = reg->Modem;
+    run->Addr = reg->Addr;
+    run->Size = 1;
+    run->Offset = offset;
+}
 
-    SX1276.Settings.State = RF_IDLE;
+static void SX1276BuildRegistersInit( void )
+{
+    RadioRegisters_t regs[RADIO_REGS_INIT_COUNT];
+    RadioRegisters_t reg;
+    uint8_t count = 0;
+    uint16_t i;
+    uint8_t j;
+
+    for( i = 0; i <= RADIO_REGS_INIT_COUNT; i++ )
+    {
+        if( ( i < RADIO_REGS_INIT_COUNT ) && ( SX1276IsOrderedRegister( &RadioRegsInit[i] ) == false ) )
+        {
+            reg = RadioRegsInit[i];
+
+            // A register written twice keeps the last value
+            for( j = 0; j < count; j++ )
+            {
+                if( SX1276RegisterInitKey( &regs[j] ) == SX1276RegisterInitKey( &reg ) )
+                {
+                    regs[j].Value = reg.Value;
+                    break;
+                }
+            }
+            if( j < count )
+            {
+                continue;
+            }
+
+            // Insertion sort
+            for( j = count; ( j > 0 ) && ( SX1276RegisterInitKey( &regs[j - 1] ) > SX1276RegisterInitKey( &reg ) ); j-- )
+            {
+                regs[j] = regs[j - 1];
+            }
+            regs[j] = reg;
+            count++;
+            continue;
+        }
+
+        // Barrier: the sorted entries before it, then the entry itself
+        for( j = 0; j < count; j++ )
+        {
+            SX1276AppendRegisterInit( &regs[j] );
+        }
+        count = 0;
+        if( i < RADIO_REGS_INIT_COUNT )
+        {
+            SX1276AppendRegisterInit( &RadioRegsInit[i] );
+        }
+    }
+}
+
+static void SX1276WriteRegistersInit( void )
+{
+    RadioRegistersRun_t *run = NULL;
+    RadioRegistersRun_t *previous;
+    uint8_t i;
+
+    if( RadioRegsInitRunCount == 0 )
+    {
+        SX1276BuildRegistersInit( );
+    }
+
+    for( i = 0; i < RadioRegsInitRunCount; i++ )
+    {
+        previous = run;
+        run = &RadioRegsInitRuns[i];
+
+        // SX1276SetModem reads back OpMode, which a table entry may have changed
+        if( ( previous == NULL ) || ( previous->Modem != run->Modem ) || ( previous->Addr == REG_OPMODE ) )
+        {
+            SX1276SetModem( run->Modem );
+        }
+        SX1276WriteBuffer( run->Addr, &RadioRegsInitValues[run->Offset], run->Size );
+    }
+
+    if( ( run == NULL ) || ( run->Modem != MODEM_FSK ) || ( run->Addr == REG_OPMODE ) )
+    {
+        SX1276SetModem( MODEM_FSK );
+    }
 }
 
 RadioState_t SX1276GetStatus( void )
 {
+    if( CarrierSense.Running == true )
+    {
+        // The receiver is on although the packet state machine is idle
+        return RF_RX_RUNNING;
+    }
     return SX1276.Settings.State;
 }
 
@@ -390,6 +839,63 @@ bool SX1276IsChannelFree( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThres
     return status;
 }
 
+bool SX1276StartCarrierSense( const uint32_t *freqs, uint8_t nbChannels, uint32_t rxBandwidth,
+                              int16_t rssiThresh, uint32_t senseTime,
+                              void ( *onDone )( SX1276CarrierSenseResult_t *results, uint8_t nbChannels ) )
+{
+    uint8_t i;
+
+    if( ( nbChannels == 0 ) || ( nbChannels > SX1276_CARRIER_SENSE_MAX_CHANNELS ) ||
+        ( SX1276.Settings.State != RF_IDLE ) || ( CarrierSense.Running == true ) ||
+        ( Calibration.Step != CALIBRATION_IDLE ) )
+    {
+        return false;
+    }
+
+    for( i = 0; i < nbChannels; i++ )
+    {
+        CarrierSenseResults[i].Frequency = freqs[i];
+        CarrierSenseResults[i].MaxRssi = INT16_MIN;
+        CarrierSenseResults[i].MeanRssi = INT16_MIN;
+        CarrierSenseResults[i].Samples = 0;
+        CarrierSenseResults[i].IsFree = true;
+    }
+    CarrierSense.NbChannels = nbChannels;
+    CarrierSense.Channel = 0;
+    CarrierSense.RssiThresh = rssiThresh;
+    CarrierSense.SenseTime = senseTime;
+    CarrierSense.RssiSum = 0;
+    CarrierSense.OnDone = onDone;
+    CarrierSense.Running = true;
+
+    SX1276SetSleep( );
+
+    SX1276SetModem( MODEM_FSK );
+
+    SX1276SetChannel( freqs[0] );
+
+    SX1276Write( REG_RXBW, GetFskBandwidthRegValue( rxBandwidth ) );
+    SX1276Write( REG_AFCBW, GetFskBandwidthRegValue( rxBandwidth ) );
+
+    SX1276SetOpMode( RF_OPMODE_RECEIVER );
+
+    // The first sample is taken once the receiver settled
+    TimerSetValue( &CarrierSenseTimer, SX1276_CARRIER_SENSE_PERIOD );
+    TimerStart( &CarrierSenseTimer );
+    return true;
+}
+
+void SX1276StopCarrierSense( void )
+{
+    if( CarrierSense.Running == false )
+    {
+        return;
+    }
+    TimerStop( &CarrierSenseTimer );
+    CarrierSense.Running = false;
+    SX1276SetSleep( );
+}
+
 uint32_t SX1276Random( void )
 {
     uint8_t i;
@@ -423,47 +929,227 @@ uint32_t SX1276Random( void )
 
     SX1276SetSleep( );
 
-    return rnd;
+    return rnd;
+}
+
+/*!
+ * Performs the Rx chain calibration for LF and HF bands
+ * \remark Must be called just after the reset so all registers are at their
+ *         default values
+ */
+static void RxChainCalibration( void )
+{
+    // A blocking calibration supersedes a pending asynchronous one
+    TimerStop( &CalibrationTimer );
+    Calibration.InitPending = false;
+    Calibration.OnDone = NULL;
+
+    // The temperature sample would add SX1276_TEMPERATURE_SAMPLE_TIME of
+    // DelayMs to the boot: the first SX1276CheckCalibration records it
+    Calibration.SkipTemperature = true;
+    RxChainCalibrationStart( );
+    while( RxChainCalibrationProcess( ) == false )
+    {
+    }
+    Calibration.SkipTemperature = false;
+}
+
+static void RxChainCalibrationStart( void )
+{
+    // Save context
+    Calibration.Modem = SX1276.Settings.Modem;
+    Calibration.RegPaConfig = SX1276Read( REG_PACONFIG );
+
+    Calibration.Frequency = SX1276ConvertPllStepToFreqInHz( ( ( ( uint32_t )SX1276Read( REG_FRFMSB ) << 16 ) |
+                                                              ( ( uint32_t )SX1276Read( REG_FRFMID ) << 8 ) |
+                                                              ( ( uint32_t )SX1276Read( REG_FRFLSB ) ) ) );
+
+    // Cut the PA just in case, RFO output, power = -1 dBm
+    SX1276Write( REG_PACONFIG, 0x00 );
+
+    // Launch Rx chain calibration for LF band
+    SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_MASK ) | RF_IMAGECAL_IMAGECAL_START );
+    Calibration.StartTime = TimerGetCurrentTime( );
+    Calibration.StepTime = Calibration.StartTime;
+    Calibration.Step = CALIBRATION_LF_RUNNING;
+}
+
+static bool RxChainCalibrationProcess( void )
+{
+    bool success = true;
+    int8_t temperature;
+    RadioModems_t modem;
+
+    switch( Calibration.Step )
+    {
+    case CALIBRATION_IDLE:
+        return true;
+    case CALIBRATION_TEMP_RUNNING:
+    case CALIBRATION_TEMP_CHECK:
+        if( TimerGetElapsedTime( Calibration.StepTime ) < SX1276_TEMPERATURE_SAMPLE_TIME )
+        {
+            return false;
+        }
+        temperature = SX1276TemperatureSample( );
+        if( Calibration.Step == CALIBRATION_TEMP_RUNNING )
+        {
+            CalibrationInfo.Temperature = temperature;
+            CalibrationInfo.TemperatureValid = true;
+            CalibrationInfo.Count++;
+            return RxChainCalibrationDone( );
+        }
+
+        CalibrationInfo.LastTemperature = temperature;
+        if( CalibrationInfo.TemperatureValid == false )
+        {
+            // First reading since a blocking calibration: it becomes the reference
+            CalibrationInfo.Temperature = temperature;
+            CalibrationInfo.TemperatureValid = true;
+        }
+        if( ( ( temperature - CalibrationInfo.Temperature ) <= Calibration.Threshold ) &&
+            ( ( CalibrationInfo.Temperature - temperature ) <= Calibration.Threshold ) )
+        {
+            // Calibration still valid
+            Calibration.Step = CALIBRATION_IDLE;
+            SX1276SetModem( Calibration.Modem );
+            return true;
+        }
+
+        // Already in FSK standby: recalibrate right away
+        modem = Calibration.Modem;
+        RxChainCalibrationStart( );
+        Calibration.Modem = modem;
+        return false;
+    default:
+        break;
+    }
+
+    if( ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_RUNNING ) == RF_IMAGECAL_IMAGECAL_RUNNING )
+    {
+        if( TimerGetElapsedTime( Calibration.StepTime ) <= SX1276_CALIBRATION_TIMEOUT )
+        {
+            return false;
+        }
+        CalibrationInfo.Timeouts++;
+        success = false;
+    }
+    else if( Calibration.Step == CALIBRATION_LF_RUNNING )
+    {
+        // Sets a Frequency in HF band
+        SX1276SetChannel( 868000000 );
+
+        // Launch Rx chain calibration for HF band
+        SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_MASK ) | RF_IMAGECAL_IMAGECAL_START );
+        Calibration.StepTime = TimerGetCurrentTime( );
+        Calibration.Step = CALIBRATION_HF_RUNNING;
+        return false;
+    }
+
+    // Restore context
+    SX1276Write( REG_PACONFIG, Calibration.RegPaConfig );
+    SX1276SetChannel( Calibration.Frequency );
+
+    CalibrationInfo.Valid = success;
+    if( success == false )
+    {
+        return RxChainCalibrationDone( );
+    }
+    if( Calibration.SkipTemperature == true )
+    {
+        CalibrationInfo.TemperatureValid = false;
+        CalibrationInfo.Count++;
+        return RxChainCalibrationDone( );
+    }
+
+    // Reference temperature of the new calibration, read on a later step
+    SX1276TemperatureStart( );
+    Calibration.StepTime = TimerGetCurrentTime( );
+    Calibration.Step = CALIBRATION_TEMP_RUNNING;
+    return false;
+}
+
+static bool RxChainCalibrationDone( void )
+{
+    CalibrationInfo.Duration = TimerGetElapsedTime( Calibration.StartTime );
+    Calibration.Step = CALIBRATION_IDLE;
+
+    SX1276SetModem( Calibration.Modem );
+    return true;
+}
+
+static void SX1276TemperatureStart( void )
+{
+    // The sensor is sampled in the frequency synthesis modes while the
+    // temperature monitor is on
+    SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_TEMPMONITOR_MASK ) | RF_IMAGECAL_TEMPMONITOR_ON );
+    SX1276SetOpMode( RF_OPMODE_SYNTHESIZER_RX );
 }
 
-/*!
- * Performs the Rx chain calibration for LF and HF bands
- * \remark Must be called just after the reset so all registers are at their
- *         default values
- */
-static void RxChainCalibration( void )
+static int8_t SX1276TemperatureSample( void )
 {
-    uint8_t regPaConfigInitVal;
-    uint32_t initialFreq;
+    SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_TEMPMONITOR_MASK ) | RF_IMAGECAL_TEMPMONITOR_OFF );
+    SX1276SetOpMode( RF_OPMODE_STANDBY );
 
-    // Save context
-    regPaConfigInitVal = SX1276Read( REG_PACONFIG );
+    // Two's complement, -1 °C per LSB
+    return -( int8_t )SX1276Read( REG_TEMP );
+}
 
-    initialFreq = SX1276ConvertPllStepToFreqInHz( ( ( ( uint32_t )SX1276Read( REG_FRFMSB ) << 16 ) |
-                                                    ( ( uint32_t )SX1276Read( REG_FRFMID ) << 8 ) |
-                                                    ( ( uint32_t )SX1276Read( REG_FRFLSB ) ) ) );
+bool SX1276StartCalibration( void ( *onDone )( bool success ) )
+{
+    if( ( SX1276.Settings.State != RF_IDLE ) || ( Calibration.Step != CALIBRATION_IDLE ) ||
+        ( CarrierSense.Running == true ) )
+    {
+        return false;
+    }
 
-    // Cut the PA just in case, RFO output, power = -1 dBm
-    SX1276Write( REG_PACONFIG, 0x00 );
+    // Image calibration runs from FSK standby; the modem is restored afterwards
+    RadioModems_t modem = SX1276.Settings.Modem;
+    SX1276SetModem( MODEM_FSK );
+    SX1276SetOpMode( RF_OPMODE_STANDBY );
 
-    // Launch Rx chain calibration for LF band
-    SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_MASK ) | RF_IMAGECAL_IMAGECAL_START );
-    while( ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_RUNNING ) == RF_IMAGECAL_IMAGECAL_RUNNING )
+    Calibration.InitPending = false;
+    Calibration.OnDone = onDone;
+    RxChainCalibrationStart( );
+    Calibration.Modem = modem;
+    TimerSetValue( &CalibrationTimer, 1 );
+    TimerStart( &CalibrationTimer );
+    return true;
+}
+
+bool SX1276CheckCalibration( int8_t threshold, void ( *onDone )( bool success ) )
+{
+    if( CalibrationInfo.Valid == false )
     {
+        return SX1276StartCalibration( onDone );
     }
 
-    // Sets a Frequency in HF band
-    SX1276SetChannel( 868000000 );
-
-    // Launch Rx chain calibration for HF band
-    SX1276Write( REG_IMAGECAL, ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_MASK ) | RF_IMAGECAL_IMAGECAL_START );
-    while( ( SX1276Read( REG_IMAGECAL ) & RF_IMAGECAL_IMAGECAL_RUNNING ) == RF_IMAGECAL_IMAGECAL_RUNNING )
+    if( ( SX1276.Settings.State != RF_IDLE ) || ( Calibration.Step != CALIBRATION_IDLE ) ||
+        ( CarrierSense.Running == true ) )
     {
+        return false;
     }
 
-    // Restore context
-    SX1276Write( REG_PACONFIG, regPaConfigInitVal );
-    SX1276SetChannel( initialFreq );
+    // The temperature is read by the calibration timer, which recalibrates
+    // if it drifted
+    Calibration.Modem = SX1276.Settings.Modem;
+    SX1276SetModem( MODEM_FSK );
+    SX1276SetOpMode( RF_OPMODE_STANDBY );
+
+    Calibration.Threshold = threshold;
+    Calibration.InitPending = false;
+    Calibration.OnDone = onDone;
+    SX1276TemperatureStart( );
+    Calibration.StartTime = TimerGetCurrentTime( );
+    Calibration.StepTime = Calibration.StartTime;
+    Calibration.Step = CALIBRATION_TEMP_CHECK;
+    TimerSetValue( &CalibrationTimer, 1 );
+    TimerStart( &CalibrationTimer );
+    return true;
+}
+
+void SX1276GetCalibrationInfo( SX1276CalibrationInfo_t *info )
+{
+    *info = CalibrationInfo;
 }
 
 void SX1276SetRxConfig( RadioModems_t modem, uint32_t bandwidth,
@@ -787,20 +1473,46 @@ uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint32_t bandwidth,
         break;
     case MODEM_LORA:
         {
-            numerator   = 1000U * SX1276GetLoRaTimeOnAirNumerator( bandwidth, datarate, coderate, preambleLen, fixLen,
-                                                                   payloadLen, crcOn );
-            denominator = SX1276GetLoRaBandwidthInHz( bandwidth );
+            if( ( bandwidth > 2 ) || ( datarate < SX1276_LORA_DATARATE_MIN ) ||
+                ( datarate >= ( SX1276_LORA_DATARATE_MIN + SX1276_LORA_DATARATE_COUNT ) ) )
+            {
+                return 0;
+            }
+            return SX1276GetLoRaTimeOnAir( &LoRaTimeOnAirTable[bandwidth][datarate - SX1276_LORA_DATARATE_MIN],
+                                           datarate, coderate, preambleLen, fixLen, payloadLen, crcOn );
         }
-        break;
     }
     // Perform integral ceil()
     return ( numerator + denominator - 1 ) / denominator;
 }
 
+void SX1276GetTimeOnAirBatch( uint32_t bandwidth, uint8_t coderate,
+                              uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                              bool crcOn, uint32_t *airTime )
+{
+    uint8_t i;
+
+    for( i = 0; i < SX1276_LORA_DATARATE_COUNT; i++ )
+    {
+        if( bandwidth > 2 )
+        {
+            airTime[i] = 0;
+            continue;
+        }
+        airTime[i] = SX1276GetLoRaTimeOnAir( &LoRaTimeOnAirTable[bandwidth][i], SX1276_LORA_DATARATE_MIN + i,
+                                             coderate, preambleLen, fixLen, payloadLen, crcOn );
+    }
+}
+
 void SX1276Send( uint8_t *buffer, uint8_t size )
 {
     uint32_t txTimeout = 0;
 
+    if( CarrierSense.Running == true )
+    {
+        return;
+    }
+
     switch( SX1276.Settings.Modem )
     {
     case MODEM_FSK:
@@ -823,7 +1535,7 @@ void SX1276Send( uint8_t *buffer, uint8_t size )
             }
             else
             {
-                memcpy1( RxTxBuffer, buffer, size );
+                memcpy1( TxBuffer, buffer, size );
                 SX1276.Settings.FskPacketHandler.ChunkSize = 32;
             }
 
@@ -898,6 +1610,11 @@ void SX1276SetStby( void )
 void SX1276SetRx( uint32_t timeout )
 {
     bool rxContinuous = false;
+
+    if( CarrierSense.Running == true )
+    {
+        return;
+    }
     TimerStop( &TxTimeoutTimer );
 
     switch( SX1276.Settings.Modem )
@@ -1030,8 +1747,6 @@ void SX1276SetRx( uint32_t timeout )
         break;
     }
 
-    memset( RxTxBuffer, 0, ( size_t )RX_TX_BUFFER_SIZE );
-
     SX1276.Settings.State = RF_RX_RUNNING;
     if( timeout != 0 )
     {
@@ -1128,6 +1843,11 @@ static void SX1276SetTx( uint32_t timeout )
 
 void SX1276StartCad( void )
 {
+    if( CarrierSense.Running == true )
+    {
+        return;
+    }
+
     switch( SX1276.Settings.Modem )
     {
     case MODEM_FSK:
@@ -1163,6 +1883,11 @@ void SX1276SetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
 {
     uint32_t timeout = ( uint32_t )time * 1000;
 
+    if( CarrierSense.Running == true )
+    {
+        return;
+    }
+
     SX1276SetChannel( freq );
 
     SX1276SetTxConfig( MODEM_FSK, power, 0, 0, 4800, 0, 5, false, false, 0, 0, 0, timeout );
@@ -1288,18 +2013,27 @@ uint8_t SX1276Read( uint32_t addr )
     return data;
 }
 
-void SX1276WriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
+__attribute__( ( weak ) ) void SpiInOutBuffer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size )
 {
-    uint8_t i;
+    uint16_t i;
+
+    for( i = 0; i < size; i++ )
+    {
+        uint8_t data = SpiInOut( obj, ( txBuffer != NULL ) ? txBuffer[i] : 0 );
+        if( rxBuffer != NULL )
+        {
+            rxBuffer[i] = data;
+        }
+    }
+}
 
+void SX1276WriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
+{
     //NSS = 0;
     GpioWrite( &SX1276.Spi.Nss, 0 );
 
     SpiInOut( &SX1276.Spi, addr | 0x80 );
-    for( i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX1276.Spi, buffer[i] );
-    }
+    SpiInOutBuffer( &SX1276.Spi, buffer, NULL, size );
 
     //NSS = 1;
     GpioWrite( &SX1276.Spi.Nss, 1 );
@@ -1307,17 +2041,11 @@ void SX1276WriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 
 void SX1276ReadBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
-    uint8_t i;
-
     //NSS = 0;
     GpioWrite( &SX1276.Spi.Nss, 0 );
 
     SpiInOut( &SX1276.Spi, addr & 0x7F );
-
-    for( i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX1276.Spi, 0 );
-    }
+    SpiInOutBuffer( &SX1276.Spi, NULL, buffer, size );
 
     //NSS = 1;
     GpioWrite( &SX1276.Spi.Nss, 1 );
@@ -1372,6 +2100,182 @@ uint32_t SX1276GetWakeupTime( void )
     return SX1276GetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
 }
 
+static RxFrame_t *SX1276RxFrameFromBuffer( const uint8_t *buffer )
+{
+    uint8_t i;
+
+    for( i = 0; i < SX1276_RX_POOL_SIZE; i++ )
+    {
+        if( buffer == RxPool[i].Buffer )
+        {
+            return &RxPool[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t *SX1276RxBufferGet( void )
+{
+    uint8_t i;
+
+    if( RxBuffer != NULL )
+    {
+        return RxBuffer;
+    }
+    if( RxDropping == true )
+    {
+        return NULL;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    for( i = 0; i < SX1276_RX_POOL_SIZE; i++ )
+    {
+        if( RxPool[i].RefCount == 0 )
+        {
+            // The driver holds one reference until RxDone returns
+            RxPool[i].RefCount = 1;
+            RxFrame = &RxPool[i];
+            RxPoolStats.InUse++;
+            RxPoolStats.Allocations++;
+            if( RxPoolStats.InUse > RxPoolStats.HighWater )
+            {
+                RxPoolStats.HighWater = RxPoolStats.InUse;
+            }
+            break;
+        }
+    }
+    if( RxFrame == NULL )
+    {
+        // Pool exhausted: the upper layer holds every slot
+        RxPoolStats.Exhausted++;
+        RxDropping = true;
+    }
+    else
+    {
+        RxBuffer = RxFrame->Buffer;
+    }
+    CRITICAL_SECTION_END( );
+
+    return RxBuffer;
+}
+
+static void SX1276ReadRxFifo( uint8_t offset, uint8_t size )
+{
+    uint8_t discard[16];
+    uint8_t *buffer;
+    uint8_t chunk;
+
+    if( offset == 0 )
+    {
+        RxDropping = false;
+    }
+    buffer = SX1276RxBufferGet( );
+    if( buffer != NULL )
+    {
+        SX1276ReadFifo( buffer + offset, size );
+        return;
+    }
+
+    // The FSK packet engine needs the FIFO drained even for a dropped packet
+    while( size > 0 )
+    {
+        chunk = ( size < sizeof( discard ) ) ? size : sizeof( discard );
+        SX1276ReadFifo( discard, chunk );
+        size -= chunk;
+    }
+}
+
+static void SX1276RxDeliver( uint16_t size, int16_t rssi, int8_t snr )
+{
+    uint8_t *buffer = SX1276RxBufferGet( );
+
+    if( buffer == NULL )
+    {
+        if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
+        {
+            RadioEvents->RxError( );
+        }
+    }
+    else if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+    {
+        RxDelivering = true;
+        RadioEvents->RxDone( buffer, size, rssi, snr );
+        RxDelivering = false;
+    }
+    SX1276RxBufferHandOff( );
+}
+
+static void SX1276RxBufferHandOff( void )
+{
+    RxFrame_t *frame = RxFrame;
+
+    RxFrame = NULL;
+    RxBuffer = NULL;
+    RxDropping = false;
+    if( frame != NULL )
+    {
+        SX1276RxBufferRelease( frame->Buffer );
+    }
+}
+
+bool SX1276RxBufferRetain( const uint8_t *buffer )
+{
+    RxFrame_t *frame = SX1276RxFrameFromBuffer( buffer );
+    bool retained = false;
+
+    if( frame == NULL )
+    {
+        return false;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    // A recycled slot, or one being filled by a newer packet, is refused
+    if( ( frame->RefCount > 0 ) && ( ( frame != RxFrame ) || ( RxDelivering == true ) ) )
+    {
+        frame->RefCount++;
+        retained = true;
+    }
+    CRITICAL_SECTION_END( );
+    return retained;
+}
+
+void SX1276RxBufferRelease( const uint8_t *buffer )
+{
+    RxFrame_t *frame = SX1276RxFrameFromBuffer( buffer );
+
+    if( frame == NULL )
+    {
+        return;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    if( frame->RefCount > 0 )
+    {
+        frame->RefCount--;
+        if( frame->RefCount == 0 )
+        {
+            RxPoolStats.InUse--;
+        }
+    }
+    CRITICAL_SECTION_END( );
+}
+
+void SX1276GetRxPoolStats( SX1276RxPoolStats_t *stats )
+{
+    CRITICAL_SECTION_BEGIN( );
+    *stats = RxPoolStats;
+    CRITICAL_SECTION_END( );
+}
+
+void SX1276ResetRxPoolStats( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+    RxPoolStats.HighWater = RxPoolStats.InUse;
+    RxPoolStats.Allocations = 0;
+    RxPoolStats.Exhausted = 0;
+    CRITICAL_SECTION_END( );
+}
+
 static uint32_t SX1276ConvertPllStepToFreqInHz( uint32_t pllSteps )
 {
     uint32_t freqInHzInt;
@@ -1418,26 +2322,6 @@ static uint8_t GetFskBandwidthRegValue( uint32_t bw )
     while( 1 );
 }
 
-static uint32_t SX1276GetLoRaBandwidthInHz( uint32_t bw )
-{
-    uint32_t bandwidthInHz = 0;
-
-    switch( bw )
-    {
-    case 0: // 125 kHz
-        bandwidthInHz = 125000UL;
-        break;
-    case 1: // 250 kHz
-        bandwidthInHz = 250000UL;
-        break;
-    case 2: // 500 kHz
-        bandwidthInHz = 500000UL;
-        break;
-    }
-
-    return bandwidthInHz;
-}
-
 static uint32_t SX1276GetGfskTimeOnAirNumerator( uint16_t preambleLen, bool fixLen,
                                                  uint8_t payloadLen, bool crcOn )
 {
@@ -1453,69 +2337,42 @@ static uint32_t SX1276GetGfskTimeOnAirNumerator( uint16_t preambleLen, bool fixL
              );
 }
 
-static uint32_t SX1276GetLoRaTimeOnAirNumerator( uint32_t bandwidth,
+static uint32_t SX1276GetLoRaTimeOnAir( const LoRaTimeOnAir_t *toa,
                               uint32_t datarate, uint8_t coderate,
                               uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
                               bool crcOn )
 {
-    int32_t crDenom           = coderate + 4;
-    bool    lowDatareOptimize = false;
+    uint32_t symbols;
+    int32_t  payloadBits = ( payloadLen << 3 ) +
+                           ( crcOn ? 16 : 0 ) -
+                           ( 4 * datarate ) +
+                           ( fixLen ? 0 : 20 );
 
-    // Ensure that the preamble length is at least 12 symbols when using SF5 or
-    // SF6
-    if( ( datarate == 5 ) || ( datarate == 6 ) )
+    if( datarate <= 6 )
     {
+        // Ensure that the preamble length is at least 12 symbols when using
+        // SF5 or SF6
         if( preambleLen < 12 )
         {
             preambleLen = 12;
         }
-    }
-
-    if( ( ( bandwidth == 0 ) && ( ( datarate == 11 ) || ( datarate == 12 ) ) ) ||
-        ( ( bandwidth == 1 ) && ( datarate == 12 ) ) )
-    {
-        lowDatareOptimize = true;
-    }
-
-    int32_t ceilDenominator;
-    int32_t ceilNumerator = ( payloadLen << 3 ) +
-                            ( crcOn ? 16 : 0 ) -
-                            ( 4 * datarate ) +
-                            ( fixLen ? 0 : 20 );
-
-    if( datarate <= 6 )
-    {
-        ceilDenominator = 4 * datarate;
+        symbols = preambleLen + 12 + 2;
     }
     else
     {
-        ceilNumerator += 8;
-
-        if( lowDatareOptimize == true )
-        {
-            ceilDenominator = 4 * ( datarate - 2 );
-        }
-        else
-        {
-            ceilDenominator = 4 * datarate;
-        }
-    }
-
-    if( ceilNumerator < 0 )
-    {
-        ceilNumerator = 0;
+        payloadBits += 8;
+        symbols = preambleLen + 12;
     }
 
-    // Perform integral ceil()
-    int32_t intermediate =
-        ( ( ceilNumerator + ceilDenominator - 1 ) / ceilDenominator ) * crDenom + preambleLen + 12;
-
-    if( datarate <= 6 )
+    if( payloadBits > 0 )
     {
-        intermediate += 2;
+        // Integral ceil( payloadBits / BitsPerBlock ) through the reciprocal
+        symbols += ( ( ( uint32_t )payloadBits + toa->BitsPerBlock - 1 ) * toa->BlockReciprocal >> 20 ) *
+                   ( coderate + 4 );
     }
 
-    return ( uint32_t )( ( 4 * intermediate + 1 ) * ( 1 << ( datarate - 2 ) ) );
+    // The preamble counts an extra 0.25 symbol
+    return ( ( ( 4 * symbols + 1 ) << toa->QuarterSymbolShift ) + 999 ) / 1000;
 }
 
 static void SX1276OnTimeoutIrq( void* context )
@@ -1572,12 +2429,7 @@ static void SX1276OnTimeoutIrq( void* context )
         // Initialize radio default values
         SX1276SetOpMode( RF_OPMODE_SLEEP );
 
-        for( uint8_t i = 0; i < sizeof( RadioRegsInit ) / sizeof( RadioRegisters_t ); i++ )
-        {
-            SX1276SetModem( RadioRegsInit[i].Modem );
-            SX1276Write( RadioRegsInit[i].Addr, RadioRegsInit[i].Value );
-        }
-        SX1276SetModem( MODEM_FSK );
+        SX1276WriteRegistersInit( );
 
         // Restore previous network type setting.
         SX1276SetPublicNetwork( SX1276.Settings.LoRa.PublicNetwork );
@@ -1594,6 +2446,91 @@ static void SX1276OnTimeoutIrq( void* context )
     }
 }
 
+static void SX1276OnCalibrationTimerIrq( void* context )
+{
+    void ( *onDone )( bool success ) = Calibration.OnDone;
+
+    TimerStop( &CalibrationTimer );
+    if( RxChainCalibrationProcess( ) == false )
+    {
+        TimerStart( &CalibrationTimer );
+        return;
+    }
+
+    if( Calibration.InitPending == true )
+    {
+        Calibration.InitPending = false;
+        SX1276InitRegisters( );
+    }
+    else
+    {
+        SX1276SetOpMode( RF_OPMODE_SLEEP );
+    }
+
+    Calibration.OnDone = NULL;
+    if( onDone != NULL )
+    {
+        onDone( CalibrationInfo.Valid );
+    }
+}
+
+static void SX1276OnCarrierSenseTimerIrq( void* context )
+{
+    SX1276CarrierSenseResult_t *result = &CarrierSenseResults[CarrierSense.Channel];
+    int16_t rssi;
+
+    TimerStop( &CarrierSenseTimer );
+    if( CarrierSense.Running == false )
+    {
+        return;
+    }
+
+    rssi = SX1276ReadRssi( MODEM_FSK );
+    if( result->Samples == 0 )
+    {
+        CarrierSense.ChannelStart = TimerGetCurrentTime( );
+    }
+    result->Samples++;
+    CarrierSense.RssiSum += rssi;
+    if( rssi > result->MaxRssi )
+    {
+        result->MaxRssi = rssi;
+    }
+    if( rssi > CarrierSense.RssiThresh )
+    {
+        // Busy, no need to keep sensing this channel
+        result->IsFree = false;
+    }
+
+    if( ( result->IsFree == true ) && ( TimerGetElapsedTime( CarrierSense.ChannelStart ) < CarrierSense.SenseTime ) )
+    {
+        TimerStart( &CarrierSenseTimer );
+        return;
+    }
+
+    result->MeanRssi = ( int16_t )( CarrierSense.RssiSum / result->Samples );
+    CarrierSense.RssiSum = 0;
+    CarrierSense.Channel++;
+
+    if( CarrierSense.Channel < CarrierSense.NbChannels )
+    {
+        // Retune and let the receiver settle before the next sample
+        SX1276SetOpMode( RF_OPMODE_STANDBY );
+        SX1276SetChannel( CarrierSenseResults[CarrierSense.Channel].Frequency );
+        SX1276SetOpMode( RF_OPMODE_RECEIVER );
+        TimerStart( &CarrierSenseTimer );
+        return;
+    }
+
+    CarrierSense.Running = false;
+    SX1276SetSleep( );
+
+    if( CarrierSense.OnDone != NULL )
+    {
+        CarrierSense.OnDone( CarrierSenseResults, CarrierSense.NbChannels );
+    }
+}
+
 static void SX1276OnDio0Irq( void* context )
 {
     volatile uint8_t irqFlags = 0;
@@ -1653,12 +2590,12 @@ static void SX1276OnDio0Irq( void* context )
                     {
                         SX1276.Settings.FskPacketHandler.Size = SX1276Read( REG_PAYLOADLENGTH );
                     }
-                    SX1276ReadFifo( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
+                    SX1276ReadRxFifo( SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                     SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                 }
                 else
                 {
-                    SX1276ReadFifo( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
+                    SX1276ReadRxFifo( SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                     SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                 }
 
@@ -1675,10 +2612,7 @@ static void SX1276OnDio0Irq( void* context )
                     SX1276Write( REG_RXCONFIG, SX1276Read( REG_RXCONFIG ) | RF_RXCONFIG_RESTARTRXWITHOUTPLLLOCK );
                 }
 
-                if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
-                {
-                    RadioEvents->RxDone( RxTxBuffer, SX1276.Settings.FskPacketHandler.Size, SX1276.Settings.FskPacketHandler.RssiValue, 0 );
-                }
+                SX1276RxDeliver( SX1276.Settings.FskPacketHandler.Size, SX1276.Settings.FskPacketHandler.RssiValue, 0 );
                 SX1276.Settings.FskPacketHandler.PreambleDetected = false;
                 SX1276.Settings.FskPacketHandler.SyncWordDetected = false;
                 SX1276.Settings.FskPacketHandler.NbBytes = 0;
@@ -1738,8 +2672,13 @@ static void SX1276OnDio0Irq( void* context )
                     }
 
                     SX1276.Settings.LoRaPacketHandler.Size = SX1276Read( REG_LR_RXNBBYTES );
-                    SX1276Write( REG_LR_FIFOADDRPTR, SX1276Read( REG_LR_FIFORXCURRENTADDR ) );
-                    SX1276ReadFifo( RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size );
+                    // A dropped packet is left in the FIFO: LoRa needs no draining
+                    RxDropping = false;
+                    if( SX1276RxBufferGet( ) != NULL )
+                    {
+                        SX1276Write( REG_LR_FIFOADDRPTR, SX1276Read( REG_LR_FIFORXCURRENTADDR ) );
+                        SX1276ReadFifo( SX1276RxBufferGet( ), SX1276.Settings.LoRaPacketHandler.Size );
+                    }
 
                     if( SX1276.Settings.LoRa.RxContinuous == false )
                     {
@@ -1747,10 +2686,7 @@ static void SX1276OnDio0Irq( void* context )
                     }
                     TimerStop( &RxTimeoutTimer );
 
-                    if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
-                    {
-                        RadioEvents->RxDone( RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size, SX1276.Settings.LoRaPacketHandler.RssiValue, SX1276.Settings.LoRaPacketHandler.SnrValue );
-                    }
+                    SX1276RxDeliver( SX1276.Settings.LoRaPacketHandler.Size, SX1276.Settings.LoRaPacketHandler.RssiValue, SX1276.Settings.LoRaPacketHandler.SnrValue );
                 }
                 break;
             default:
@@ -1825,12 +2761,12 @@ static void SX1276OnDio1Irq( void* context )
                 //              when FifoLevel fires
                 if( ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes ) >= SX1276.Settings.FskPacketHandler.FifoThresh )
                 {
-                    SX1276ReadFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.FifoThresh - 1 );
+                    SX1276ReadRxFifo( SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.FifoThresh - 1 );
                     SX1276.Settings.FskPacketHandler.NbBytes += SX1276.Settings.FskPacketHandler.FifoThresh - 1;
                 }
                 else
                 {
-                    SX1276ReadFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
+                    SX1276ReadRxFifo( SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                     SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                 }
                 break;
@@ -1879,13 +2815,13 @@ static void SX1276OnDio1Irq( void* context )
                 // FifoLevel interrupt
                 if( ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes ) > SX1276.Settings.FskPacketHandler.ChunkSize )
                 {
-                    SX1276WriteFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.ChunkSize );
+                    SX1276WriteFifo( ( TxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.ChunkSize );
                     SX1276.Settings.FskPacketHandler.NbBytes += SX1276.Settings.FskPacketHandler.ChunkSize;
                 }
                 else
                 {
                     // Write the last chunk of data
-                    SX1276WriteFifo( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
+                    SX1276WriteFifo( TxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
                     SX1276.Settings.FskPacketHandler.NbBytes += SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes;
                 }
                 break;
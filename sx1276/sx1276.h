@@ -51,6 +51,39 @@ extern "C"
  */
 #define LORA_MAC_PUBLIC_SYNCWORD                    0x34
 
+/*!
+ * Number of reference counted reception buffers
+ */
+#ifndef SX1276_RX_POOL_SIZE
+#define SX1276_RX_POOL_SIZE                         4
+#endif
+
+/*!
+ * LoRa spreading factors covered by SX1276GetTimeOnAirBatch [SF5..SF12]
+ */
+#define SX1276_LORA_DATARATE_MIN                    5
+#define SX1276_LORA_DATARATE_COUNT                  8
+
+/*!
+ * Maximum duration of each band image calibration
+ */
+#define SX1276_CALIBRATION_TIMEOUT                  20 // [ms]
+
+/*!
+ * Die temperature change that requires a new Rx chain calibration
+ */
+#define SX1276_CALIBRATION_TEMP_THRESHOLD           10 // [°C]
+
+/*!
+ * Maximum number of channels sensed by SX1276StartCarrierSense
+ */
+#define SX1276_CARRIER_SENSE_MAX_CHANNELS           8
+
+/*!
+ * RSSI sampling period of SX1276StartCarrierSense
+ */
+#define SX1276_CARRIER_SENSE_PERIOD                 1 // [ms]
+
 /*!
  * Radio FSK modem parameters
  */
@@ -149,6 +182,43 @@ typedef struct SX1276_s
     RadioSettings_t Settings;
 }SX1276_t;
 
+/*!
+ * Reception buffer pool statistics
+ */
+typedef struct
+{
+    uint8_t  InUse;          //!< Slots currently referenced
+    uint8_t  HighWater;      //!< Maximum of InUse since the last reset
+    uint32_t Allocations;    //!< Packets received into a pool slot
+    uint32_t Exhausted;      //!< Packets dropped because every slot was held
+}SX1276RxPoolStats_t;
+
+/*!
+ * Rx chain calibration results
+ */
+typedef struct
+{
+    bool     Valid;             //!< Image calibration done since the last radio reset
+    int8_t   Temperature;       //!< Die temperature at calibration time [°C, uncalibrated]
+    bool     TemperatureValid;  //!< Temperature was read: false after SX1276Init until SX1276CheckCalibration
+    int8_t   LastTemperature;   //!< Last reading taken by SX1276CheckCalibration [°C]
+    uint32_t Duration;          //!< Duration of the last calibration [ms]
+    uint32_t Count;             //!< Successful calibrations
+    uint32_t Timeouts;          //!< Band calibrations that exceeded SX1276_CALIBRATION_TIMEOUT
+}SX1276CalibrationInfo_t;
+
+/*!
+ * Carrier sense result of one channel
+ */
+typedef struct
+{
+    uint32_t Frequency;         //!< Channel RF frequency [Hz]
+    int16_t  MaxRssi;           //!< Maximum sampled RSSI [dBm]
+    int16_t  MeanRssi;          //!< Mean sampled RSSI [dBm]
+    uint32_t Samples;           //!< Number of RSSI samples
+    bool     IsFree;            //!< No sample exceeded the RSSI threshold
+}SX1276CarrierSenseResult_t;
+
 /*!
  * Hardware IO IRQ callback function definition
  */
@@ -167,13 +237,73 @@ typedef void ( DioIrqHandler )( void* context );
 /*!
  * \brief Initializes the radio
  *
+ * \remark Blocks for the Rx chain calibration only. The reference
+ *         temperature is not read: the first SX1276CheckCalibration records
+ *         it. SX1276InitAsync reads it.
+ *
  * \param [IN] events Structure containing the driver callback functions
  */
 void SX1276Init( RadioEvents_t *events );
 
+/*!
+ * \brief Initializes the radio without waiting for the Rx chain calibration
+ *
+ * \remark Returns right after the radio reset. The calibration is polled
+ *         from a timer and the registers are initialized once it completes.
+ *         No other radio function may be called before onReady.
+ *
+ * \param [IN] events  Structure containing the driver callback functions
+ * \param [IN] onReady Called when the radio is ready [calibrated: false when
+ *                     the calibration timed out]
+ */
+void SX1276InitAsync( RadioEvents_t *events, void ( *onReady )( bool calibrated ) );
+
+/*!
+ * \brief Starts an asynchronous Rx chain calibration of an idle radio
+ *
+ * \remark The radio is left in sleep mode when onDone is called.
+ *
+ * \param [IN] onDone Called when the calibration completes
+ *
+ * \retval started false when the radio is busy
+ */
+bool SX1276StartCalibration( void ( *onDone )( bool success ) );
+
+/*!
+ * \brief Recalibrates the Rx chain if the die temperature drifted
+ *
+ * \remark Meant to be called on wake-up from sleep, which keeps the
+ *         calibration. A radio reset loses it: SX1276Init always
+ *         recalibrates.
+ *
+ * \remark After SX1276Init the first reading only records the reference
+ *         temperature of the calibration.
+ *
+ * \remark Non blocking: the temperature is read by the calibration timer,
+ *         which then recalibrates only if it drifted. The radio is put to
+ *         sleep in both cases.
+ *
+ * \param [IN] threshold Allowed temperature change since the last
+ *                       calibration [°C], see SX1276_CALIBRATION_TEMP_THRESHOLD
+ * \param [IN] onDone    Called when the check, and the recalibration if
+ *                       any, completes
+ *
+ * \retval started false when the radio is busy
+ */
+bool SX1276CheckCalibration( int8_t threshold, void ( *onDone )( bool success ) );
+
+/*!
+ * \brief Gets the Rx chain calibration results
+ *
+ * \param [OUT] info Calibration state, temperature and duration
+ */
+void SX1276GetCalibrationInfo( SX1276CalibrationInfo_t *info );
+
 /*!
  * Return current radio status
  *
+ * \remark A running SX1276StartCarrierSense reports RF_RX_RUNNING
+ *
  * \param status Radio status.[RF_IDLE, RF_RX_RUNNING, RF_TX_RUNNING]
  */
 RadioState_t SX1276GetStatus( void );
@@ -206,6 +336,40 @@ void SX1276SetChannel( uint32_t freq );
  */
 bool SX1276IsChannelFree( uint32_t freq, uint32_t rxBandwidth, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
 
+/*!
+ * \brief Starts a non-blocking carrier sense over one or more channels
+ *
+ * \remark The RSSI is sampled every SX1276_CARRIER_SENSE_PERIOD from a
+ *         timer. Each channel is sensed for senseTime, or until a sample
+ *         exceeds rssiThresh, then the next channel is tuned. The radio is
+ *         put to sleep before onDone is called. The FSK modem is used as we
+ *         can select the Rx bandwidth at will.
+ *
+ * \remark The radio is busy until onDone: SX1276GetStatus reports
+ *         RF_RX_RUNNING, and SX1276Send, SX1276SetRx,
+ *         SX1276SetTxContinuousWave and SX1276StartCad are ignored. Use
+ *         SX1276StopCarrierSense to abort it.
+ *
+ * \param [IN] freqs       Channels RF frequencies in Hertz
+ * \param [IN] nbChannels  Number of channels [1..SX1276_CARRIER_SENSE_MAX_CHANNELS]
+ * \param [IN] rxBandwidth Rx bandwidth in Hertz
+ * \param [IN] rssiThresh  RSSI threshold in dBm
+ * \param [IN] senseTime   Time in milliseconds while the RSSI of each channel is measured
+ * \param [IN] onDone      Called with the per channel results, which stay
+ *                         valid until the next carrier sense
+ *
+ * \retval started false when the radio is busy or the parameters are invalid
+ */
+bool SX1276StartCarrierSense( const uint32_t *freqs, uint8_t nbChannels, uint32_t rxBandwidth,
+                              int16_t rssiThresh, uint32_t senseTime,
+                              void ( *onDone )( SX1276CarrierSenseResult_t *results, uint8_t nbChannels ) );
+
+/*!
+ * \brief Aborts a running carrier sense without calling its callback and
+ *        puts the radio to sleep
+ */
+void SX1276StopCarrierSense( void );
+
 /*!
  * \brief Generates a 32 bits random value based on the RSSI readings
  *
@@ -341,6 +505,25 @@ uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint32_t bandwidth,
                               uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
                               bool crcOn );
 
+/*!
+ * \brief Computes the LoRa packet time on air for every spreading factor
+ *
+ * \remark Same rounding as SX1276GetTimeOnAir. Meant for the duty-cycle and
+ *         RX window computations that evaluate all data rates at once.
+ *
+ * \param [IN]  bandwidth    [0: 125 kHz, 1: 250 kHz, 2: 500 kHz]
+ * \param [IN]  coderate     [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
+ * \param [IN]  preambleLen  Length in symbols (the hardware adds 4 more symbols)
+ * \param [IN]  fixLen       Fixed length packets [0: variable, 1: fixed]
+ * \param [IN]  payloadLen   Payload length in bytes
+ * \param [IN]  crcOn        Enables/Disables the CRC [0: OFF, 1: ON]
+ * \param [OUT] airTime      SX1276_LORA_DATARATE_COUNT entries, airTime[i]
+ *                           is the time on air (ms) at SF( SX1276_LORA_DATARATE_MIN + i )
+ */
+void SX1276GetTimeOnAirBatch( uint32_t bandwidth, uint8_t coderate,
+                              uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                              bool crcOn, uint32_t *airTime );
+
 /*!
  * \brief Sends the buffer of size. Prepares the packet to be sent and sets
  *        the radio in transmission
@@ -445,6 +628,48 @@ void SX1276SetPublicNetwork( bool enable );
  */
 uint32_t SX1276GetWakeupTime( void );
 
+/*!
+ * \brief Keeps a received payload alive after RadioEvents->RxDone returns
+ *
+ * \remark The payload handed to RxDone lives in a reference counted pool
+ *         slot that is recycled as soon as the callback returns. Retaining
+ *         it lets the upper layer keep the frame without copying it; every
+ *         successful retain must be matched by SX1276RxBufferRelease.
+ *         Succeeds from within RxDone or on an already retained payload.
+ *         After RxDone returned the slot may have been recycled: the call
+ *         then fails instead of pinning a newer packet.
+ *
+ * \remark Only the RxDone consumer itself can retain. Buffers derived
+ *         from the payload further up, such as the application data the
+ *         MAC decrypts into its own buffer, are not pool slots.
+ *
+ * \param [IN] buffer Payload pointer received by RxDone
+ *
+ * \retval retained false when the payload is not a live pool slot; it must
+ *                  then be copied
+ */
+bool SX1276RxBufferRetain( const uint8_t *buffer );
+
+/*!
+ * \brief Releases a payload previously retained with SX1276RxBufferRetain
+ *
+ * \param [IN] buffer Payload pointer received by RxDone
+ */
+void SX1276RxBufferRelease( const uint8_t *buffer );
+
+/*!
+ * \brief Gets the reception buffer pool statistics
+ *
+ * \param [OUT] stats Current pool usage and high-water mark
+ */
+void SX1276GetRxPoolStats( SX1276RxPoolStats_t *stats );
+
+/*!
+ * \brief Resets the pool counters. The high-water mark restarts at the
+ *        current usage.
+ */
+void SX1276ResetRxPoolStats( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,104 @@
+// Rajadas do sx1276 sobre bibliotecas/SPI no SDK simulado: o SpiInOutBuffer
+// de sx1276-board-spi.c contra o padrão weak de sx1276.c, que chama o
+// SpiInOut da placa (SPI_transfer) uma vez por byte
+#include <string.h>
+#include "host-sdk.h"
+#include "hardware/spi.h"
+#include "spi.h"
+#include "SPI.h"
+#include "check.h"
+
+// Ciclos de CPU a 125 MHz gastos em cada chamada spi_*_blocking fora o
+// tempo dos bytes: entrada, laço e espera das FIFOs (estimativa)
+#define SDK_CALL_CYCLES 60
+
+void SpiInOutBuffer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size );
+
+static Spi_t spi;
+
+static void weak_default( const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size )
+{
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        uint8_t data = SPI_transfer( ( txBuffer != NULL ) ? txBuffer[i] : 0 );
+        if( rxBuffer != NULL )
+        {
+            rxBuffer[i] = data;
+        }
+    }
+}
+
+typedef struct
+{
+    uint32_t Calls;
+    uint32_t Bytes;
+    uint64_t Cycles;
+}cost_t;
+
+static cost_t measure( void ( *transfer )( const uint8_t *, uint8_t *, uint16_t ),
+                       const uint8_t *tx, uint8_t *rx, uint16_t size )
+{
+    cost_t cost;
+
+    host_sdk_reset_counters( );
+    transfer( tx, rx, size );
+    cost.Calls = host_sdk_spi_calls( );
+    cost.Bytes = host_sdk_spi_bytes( );
+    cost.Cycles = host_sdk_cpu_busy_ns( ) * 125 / 1000 + ( uint64_t )cost.Calls * SDK_CALL_CYCLES;
+    return cost;
+}
+
+static void board_buffer( const uint8_t *tx, uint8_t *rx, uint16_t size )
+{
+    SpiInOutBuffer( &spi, tx, rx, size );
+}
+
+static void report( const char *name, uint16_t size, cost_t before, cost_t after )
+{
+    printf( "%s %3u bytes: %3u -> %u chamadas, %6llu -> %6llu ciclos\n", name, size,
+            before.Calls, after.Calls, ( unsigned long long )before.Cycles,
+            ( unsigned long long )after.Cycles );
+}
+
+static void bench( bool dma )
+{
+    static const uint16_t sizes[] = { 4, 16, 64, 255 };
+    uint8_t tx[255];
+    uint8_t rx[255];
+
+    memset( tx, 0xA5, sizeof( tx ) );
+    for( unsigned i = 0; i < sizeof( sizes ) / sizeof( sizes[0] ); i++ )
+    {
+        uint16_t size = sizes[i];
+        cost_t before = measure( weak_default, tx, NULL, size );
+        cost_t after = measure( board_buffer, tx, NULL, size );
+
+        // Os mesmos bytes no barramento, numa chamada só
+        CHECK_EQ( after.Bytes, before.Bytes );
+        CHECK( after.Calls <= 1 );
+        CHECK( after.Cycles < before.Cycles );
+        report( dma ? "escrita DMA" : "escrita    ", size, before, after );
+
+        before = measure( weak_default, NULL, rx, size );
+        after = measure( board_buffer, NULL, rx, size );
+        CHECK_EQ( after.Bytes, before.Bytes );
+        CHECK( after.Cycles < before.Cycles );
+        report( dma ? "leitura DMA" : "leitura    ", size, before, after );
+
+        // Sem tx nem rx: só clock, com os mesmos bytes no barramento
+        before = measure( weak_default, NULL, NULL, size );
+        after = measure( board_buffer, NULL, NULL, size );
+        CHECK_EQ( after.Bytes, before.Bytes );
+    }
+}
+
+int main( void )
+{
+    host_sdk_reset( );
+    SPI_init( );
+    spi_set_baudrate( spi0, 8 * 1000 * 1000 );
+    bench( false );
+    CHECK( SPI_enable_dma( ) );
+    bench( true );
+    return CHECK_DONE( );
+}
@@ -0,0 +1,26 @@
+#ifndef TESTES_CHECK_H
+#define TESTES_CHECK_H
+
+// Asserções mínimas dos testes em host: contam as falhas e seguem adiante
+#include <stdio.h>
+
+static int check_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) falhou\n", __FILE__, __LINE__, #cond); \
+        check_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long check_a = (long long)(a), check_b = (long long)(b); \
+    if (check_a != check_b) { \
+        fprintf(stderr, "%s:%d: %s == %s falhou (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, check_a, check_b); \
+        check_failures++; \
+    } \
+} while (0)
+
+#define CHECK_DONE() (check_failures ? (fprintf(stderr, "%d falha(s)\n", check_failures), 1) : 0)
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef HOST_SDK_HARDWARE_GPIO_H
+#define HOST_SDK_HARDWARE_GPIO_H
+
+#include "pico/stdlib.h"
+
+#define GPIO_OUT            1
+#define GPIO_IN             0
+#define GPIO_IRQ_EDGE_FALL  0x4u
+#define GPIO_IRQ_EDGE_RISE  0x8u
+
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7, GPIO_FUNC_SIO = 5 };
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+
+#endif
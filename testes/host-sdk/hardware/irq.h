@@ -0,0 +1,24 @@
+#ifndef HOST_SDK_HARDWARE_IRQ_H
+#define HOST_SDK_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+#define DMA_IRQ_0                                       11
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY  0x80
+#define PICO_LOWEST_IRQ_PRIORITY                        0xff
+#define FIRST_USER_IRQ                                  26
+#define NUM_USER_IRQS                                   6
+
+typedef void (*irq_handler_t)(void);
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+void irq_set_pending(uint num);
+
+// IRQs de software (26..31), reservadas por núcleo
+int user_irq_claim_unused(bool required);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HOST_SDK_HARDWARE_PIO_H
+#define HOST_SDK_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+// O backend PIO não é exercitado no host: as chamadas só precisam linkar
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+
+typedef struct {
+    uint32_t clkdiv;
+} pio_sm_config;
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+extern pio_hw_t *const pio0;
+extern pio_hw_t *const pio1;
+
+uint pio_get_index(PIO pio);
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+
+#endif
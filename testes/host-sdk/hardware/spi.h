@@ -0,0 +1,27 @@
+#ifndef HOST_SDK_HARDWARE_SPI_H
+#define HOST_SDK_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t dr;
+} spi_hw_t;
+
+typedef struct spi_inst {
+    spi_hw_t hw;
+    uint baudrate;
+} spi_inst_t;
+
+extern spi_inst_t host_sdk_spi[2];
+#define spi0 (&host_sdk_spi[0])
+#define spi1 (&host_sdk_spi[1])
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx);
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HOST_SDK_HARDWARE_SYNC_H
+#define HOST_SDK_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+typedef volatile uint32_t spin_lock_t;
+
+// Máscara de IRQs com contagem de aninhamento (host_sdk_irq_masked)
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+// Spin locks não reentrantes, como no RP2040: tomar um lock já tomado aborta
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+spin_lock_t *spin_lock_init(uint lock_num);
+void spin_lock_unsafe_blocking(spin_lock_t *lock);
+void spin_unlock_unsafe(spin_lock_t *lock);
+uint32_t spin_lock_blocking(spin_lock_t *lock);
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq);
+
+#endif
@@ -0,0 +1,856 @@
+#include "host-sdk.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "pico/multicore.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_ALARMS      16
+#define MAX_CHANNELS    12
+#define MAX_LOCKS       32
+#define FIFO_SIZE       8
+
+#define REG_IRQ_FLAGS       0x12
+#define REG_DIO_MAPPING_1   0x40
+
+static void fail(const char *message) {
+    fprintf(stderr, "host-sdk: %s\n", message);
+    abort();
+}
+
+spi_inst_t host_sdk_spi[2];
+pio_hw_t *const pio0 = (pio_hw_t *)0x50200000;
+pio_hw_t *const pio1 = (pio_hw_t *)0x50300000;
+
+static struct {
+    uint64_t now_ns;
+    uint64_t cpu_busy_ns;
+    bool irq_disabled;
+    int irq_depth;               // IRQs de hardware em execução
+    uint32_t user_irq_pending;   // bit i = FIRST_USER_IRQ + i
+    uint core;
+
+    // SPI: transação atual e contadores
+    LoRa_sim_t *sim;
+    uint cs;
+    uint dio0;
+    bool dio0_level;
+    bool cs_low;
+    bool have_address;
+    uint8_t address;
+    uint8_t index;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t spi_calls;
+    uint32_t gpio_irq_transactions;
+    uint baudrate;
+
+    bool gpio_irq_enabled[2][NUM_BANK0_GPIOS];   // por núcleo, como no RP2040
+    gpio_irq_callback_t gpio_callback;
+
+    struct {
+        alarm_id_t id;
+        uint64_t at_us;
+        alarm_callback_t callback;
+        void *user_data;
+        bool active;
+    } alarms[MAX_ALARMS];
+    alarm_id_t next_alarm_id;
+    bool fire_early;
+    bool fail_next;
+
+    struct {
+        bool claimed;
+        bool busy;
+        bool irq0_enabled;
+        bool irq0_status;
+        dma_channel_config config;
+        volatile void *write_addr;
+        const volatile void *read_addr;
+        uint count;
+    } dma[MAX_CHANNELS];
+    uint64_t dma_done_ns;
+    irq_handler_t dma_handler;
+
+    struct {
+        bool claimed;
+        bool held;
+    } locks[MAX_LOCKS];
+    spin_lock_t lock_words[MAX_LOCKS];
+
+    void (*core1_entry)(void);
+    uint32_t fifo[FIFO_SIZE];
+    int fifo_head;
+    int fifo_count;
+} host;
+
+// IRQs de usuário: as reservas e os handlers ficam fora de host e
+// sobrevivem a host_sdk_reset, assim como os estáticos do driver que as usa
+static struct {
+    bool claimed[2][NUM_USER_IRQS];
+    irq_handler_t handlers[NUM_USER_IRQS];
+} user_irqs;
+
+void host_sdk_reset(void) {
+    memset(&host, 0, sizeof(host));
+    memset(host_sdk_spi, 0, sizeof(host_sdk_spi));
+    host.next_alarm_id = 1;
+}
+
+void host_sdk_attach_sim(LoRa_sim_t *sim, uint cs, uint dio0) {
+    host.sim = sim;
+    host.cs = cs;
+    host.dio0 = dio0;
+    host.dio0_level = false;
+}
+
+// Relógio ---------------------------------------------------------------------
+
+void host_sdk_advance_us(uint64_t us) {
+    host.now_ns += us * 1000;
+}
+
+uint64_t host_sdk_cpu_busy_ns(void) {
+    return host.cpu_busy_ns;
+}
+
+uint64_t time_us_64(void) {
+    return host.now_ns / 1000;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+    return time_us_64() + us;
+}
+
+absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+void sleep_us(uint64_t us) {
+    host_sdk_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    host_sdk_advance_us((uint64_t)ms * 1000);
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    (void)clk_index;
+    return 125000000;
+}
+
+uint get_core_num(void) {
+    return host.core;
+}
+
+void host_sdk_set_core(uint core) {
+    host.core = core;
+}
+
+// Espera do laço principal: uma borda do DIO0 ou o próximo alarme
+void host_sdk_wfe(void) {
+    if (host_sdk_dio0_update()) return;
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (host.alarms[i].active && host.alarms[i].at_us < next) next = host.alarms[i].at_us;
+    }
+    if (next != UINT64_MAX) host_sdk_run_alarms(next);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t deadline) {
+    if (host_sdk_dio0_update()) return false;
+    host_sdk_run_alarms(deadline);
+    if (host_sdk_dio0_update()) return false;
+    return true;
+}
+
+// IRQs e spin locks -----------------------------------------------------------
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = host.irq_disabled;
+    host.irq_disabled = true;
+    return status;
+}
+
+static void user_irq_dispatch(void);
+
+void restore_interrupts(uint32_t status) {
+    host.irq_disabled = status != 0;
+    user_irq_dispatch();
+}
+
+bool host_sdk_irq_masked(void) {
+    return host.irq_disabled;
+}
+
+int spin_lock_claim_unused(bool required) {
+    for (int i = 16; i < MAX_LOCKS; i++) {
+        if (!host.locks[i].claimed) {
+            host.locks[i].claimed = true;
+            return i;
+        }
+    }
+    if (required) fail("no free spin lock");
+    return -1;
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num) {
+    return &host.lock_words[lock_num];
+}
+
+spin_lock_t *spin_lock_init(uint lock_num) {
+    host.locks[lock_num].held = false;
+    return spin_lock_instance(lock_num);
+}
+
+static int lock_index(spin_lock_t *lock) {
+    return (int)(lock - host.lock_words);
+}
+
+void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+    int i = lock_index(lock);
+    if (host.locks[i].held) fail("spin lock taken twice (deadlock on hardware)");
+    if (!host.irq_disabled) fail("spin lock taken with interrupts enabled");
+    host.locks[i].held = true;
+}
+
+void spin_unlock_unsafe(spin_lock_t *lock) {
+    int i = lock_index(lock);
+    if (!host.locks[i].held) fail("spin lock released while free");
+    host.locks[i].held = false;
+}
+
+uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    uint32_t status = save_and_disable_interrupts();
+    spin_lock_unsafe_blocking(lock);
+    return status;
+}
+
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {
+    spin_unlock_unsafe(lock);
+    restore_interrupts(saved_irq);
+}
+
+int host_sdk_locks_held(void) {
+    int held = 0;
+    for (int i = 0; i < MAX_LOCKS; i++) {
+        if (host.locks[i].held) held++;
+    }
+    return held;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    if (num == DMA_IRQ_0) host.dma_handler = handler;
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    if (num == DMA_IRQ_0 && host.dma_handler == handler) host.dma_handler = NULL;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+int user_irq_claim_unused(bool required) {
+    for (int i = NUM_USER_IRQS - 1; i >= 0; i--) {
+        if (!user_irqs.claimed[host.core][i]) {
+            user_irqs.claimed[host.core][i] = true;
+            return FIRST_USER_IRQ + i;
+        }
+    }
+    if (required) fail("no free user IRQ");
+    return -1;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num < FIRST_USER_IRQ || num >= FIRST_USER_IRQ + NUM_USER_IRQS) return;
+    irq_handler_t current = user_irqs.handlers[num - FIRST_USER_IRQ];
+    if (current && current != handler) fail("exclusive IRQ handler already set");
+    user_irqs.handlers[num - FIRST_USER_IRQ] = handler;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    (void)num;
+    (void)hardware_priority;
+}
+
+void irq_set_pending(uint num) {
+    if (num < FIRST_USER_IRQ || num >= FIRST_USER_IRQ + NUM_USER_IRQS) return;
+    host.user_irq_pending |= 1u << (num - FIRST_USER_IRQ);
+    user_irq_dispatch();
+}
+
+// As IRQs de usuário têm a prioridade mais baixa: a pendente só roda quando
+// nenhuma IRQ de hardware está ativa e as IRQs não estão mascaradas
+static void user_irq_dispatch(void) {
+    while (host.irq_depth == 0 && !host.irq_disabled && host.user_irq_pending) {
+        int i = __builtin_ctz(host.user_irq_pending);
+        host.user_irq_pending &= ~(1u << i);
+        if (!user_irqs.handlers[i]) continue;
+        host.irq_depth++;
+        user_irqs.handlers[i]();
+        host.irq_depth--;
+    }
+}
+
+static void irq_enter(void) {
+    host.irq_depth++;
+}
+
+static void irq_exit(void) {
+    host.irq_depth--;
+    user_irq_dispatch();
+}
+
+uint32_t host_sdk_gpio_irq_transactions(void) {
+    return host.gpio_irq_transactions;
+}
+
+// GPIO e DIO0 -----------------------------------------------------------------
+
+void gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+bool gpio_get(uint gpio) {
+    return gpio == host.dio0 ? host.dio0_level : false;
+}
+
+// O CS delimita as transações do SPI simulado
+void gpio_put(uint gpio, bool value) {
+    if (!host.sim || gpio != host.cs) return;
+    if (!value && !host.cs_low) {
+        host.cs_low = true;
+        host.have_address = false;
+        host.index = 0;
+        host.transactions++;
+    } else if (value) {
+        host.cs_low = false;
+    }
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    (void)events;
+    host.gpio_irq_enabled[host.core][gpio] = enabled;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, events, enabled);
+    host.gpio_callback = callback;
+}
+
+bool host_sdk_gpio_irq_enabled(uint gpio) {
+    return host.gpio_irq_enabled[host.core][gpio];
+}
+
+static bool gpio_irq_enabled_any(uint gpio) {
+    return host.gpio_irq_enabled[0][gpio] || host.gpio_irq_enabled[1][gpio];
+}
+
+// A borda chega a cada núcleo que tem a IRQ do pino ativa, um depois do outro
+void host_sdk_gpio_irq(uint gpio) {
+    if (host.irq_disabled) fail("GPIO IRQ raised with interrupts masked");
+    if (!host.gpio_callback) return;
+    uint core = host.core;
+    for (uint c = 0; c < 2; c++) {
+        if (!host.gpio_irq_enabled[c][gpio]) continue;
+        host.core = c;
+        uint32_t before = host.transactions;
+        irq_enter();
+        host.gpio_callback(gpio, GPIO_IRQ_EDGE_RISE);
+        host.gpio_irq_transactions = host.transactions - before;
+        irq_exit();
+    }
+    host.core = core;
+}
+
+// DIO0 = RxDone, TxDone ou CadDone conforme os bits 7:6 de REG_DIO_MAPPING_1
+static bool dio0_level(void) {
+    static const uint8_t masks[4] = {0x40, 0x08, 0x04, 0x00};
+    uint8_t mask = masks[host.sim->regs[REG_DIO_MAPPING_1] >> 6];
+    return (host.sim->regs[REG_IRQ_FLAGS] & mask) != 0;
+}
+
+// Depois de cada escrita: a limpeza das flags baixa o pino sem gerar IRQ
+static void dio0_sample(void) {
+    if (host.sim && !dio0_level()) host.dio0_level = false;
+}
+
+bool host_sdk_dio0_update(void) {
+    if (!host.sim) return false;
+    bool level = dio0_level();
+    bool rise = level && !host.dio0_level;
+    host.dio0_level = level;
+    if (!rise || !gpio_irq_enabled_any(host.dio0) || !host.gpio_callback) return false;
+    host_sdk_gpio_irq(host.dio0);
+    return true;
+}
+
+// SPI ---------------------------------------------------------------------------
+
+static uint64_t byte_ns(void) {
+    return host.baudrate ? 8000000000ull / host.baudrate : 0;
+}
+
+// Um byte no barramento: o primeiro de cada transação é o endereço
+static uint8_t spi_exchange(uint8_t tx) {
+    host.bytes++;
+    if (!host.sim || !host.cs_low) return 0;
+    if (!host.have_address) {
+        host.have_address = true;
+        host.address = tx;
+        return 0;
+    }
+
+    uint8_t reg = host.address & 0x7f;
+    if (reg != 0x00) reg = (reg + host.index) & 0x7f;
+    host.index++;
+
+    uint8_t rx = 0;
+    if (host.address & 0x80) {
+        LoRa_sim_transport.write_burst(host.sim, reg, &tx, 1);
+        dio0_sample();
+    } else {
+        LoRa_sim_transport.read_burst(host.sim, reg, &rx, 1);
+    }
+    return rx;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    return spi_set_baudrate(spi, baudrate);
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate) {
+    spi->baudrate = baudrate;
+    host.baudrate = baudrate;
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    (void)spi;
+    host.spi_calls++;
+    for (size_t i = 0; i < len; i++) spi_exchange(src[i]);
+    host.now_ns += len * byte_ns();
+    host.cpu_busy_ns += len * byte_ns();
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    (void)spi;
+    host.spi_calls++;
+    for (size_t i = 0; i < len; i++) dst[i] = spi_exchange(repeated_tx_data);
+    host.now_ns += len * byte_ns();
+    host.cpu_busy_ns += len * byte_ns();
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len) {
+    (void)spi;
+    host.spi_calls++;
+    for (size_t i = 0; i < len; i++) dst[i] = spi_exchange(src[i]);
+    host.now_ns += len * byte_ns();
+    host.cpu_busy_ns += len * byte_ns();
+    return (int)len;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx) {
+    return (spi == spi1 ? 18 : 16) + (is_tx ? 0 : 1);
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi) {
+    return &spi->hw;
+}
+
+uint32_t host_sdk_spi_transactions(void) {
+    return host.transactions;
+}
+
+uint32_t host_sdk_spi_bytes(void) {
+    return host.bytes;
+}
+
+uint32_t host_sdk_spi_calls(void) {
+    return host.spi_calls;
+}
+
+void host_sdk_reset_counters(void) {
+    host.transactions = 0;
+    host.bytes = 0;
+    host.spi_calls = 0;
+    host.cpu_busy_ns = 0;
+}
+
+// DMA -----------------------------------------------------------------------------
+
+int dma_claim_unused_channel(bool required) {
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!host.dma[i].claimed) {
+            host.dma[i].claimed = true;
+            return i;
+        }
+    }
+    if (required) fail("no free DMA channel");
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    host.dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config c = {true, false};
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    (void)c;
+    if (size != DMA_SIZE_8) fail("only 8-bit DMA is modelled");
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    (void)c;
+    (void)dreq;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_increment = incr;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    host.dma[channel].config = *config;
+    host.dma[channel].write_addr = write_addr;
+    host.dma[channel].read_addr = read_addr;
+    host.dma[channel].count = transfer_count;
+    if (trigger) dma_start_channel_mask(1u << channel);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+    uint count = 0;
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!(chan_mask & (1u << i))) continue;
+        if (host.dma[i].busy) fail("DMA channel restarted while busy");
+        host.dma[i].busy = true;
+        count = host.dma[i].count;
+    }
+    host.dma_done_ns = host.now_ns + count * byte_ns();
+}
+
+bool host_sdk_dma_busy(void) {
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (host.dma[i].busy) return true;
+    }
+    return false;
+}
+
+// Move os bytes do par TX (escreve em DR) / RX (lê de DR) em andamento
+static void dma_run(void) {
+    int tx = -1, rx = -1;
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!host.dma[i].busy) continue;
+        if (host.dma[i].write_addr == &spi0->hw.dr || host.dma[i].write_addr == &spi1->hw.dr) tx = i;
+        if (host.dma[i].read_addr == &spi0->hw.dr || host.dma[i].read_addr == &spi1->hw.dr) rx = i;
+    }
+    if (tx < 0 || rx < 0) fail("DMA burst without a TX/RX channel pair");
+
+    const volatile uint8_t *src = host.dma[tx].read_addr;
+    volatile uint8_t *dst = host.dma[rx].write_addr;
+    for (uint i = 0; i < host.dma[tx].count; i++) {
+        uint8_t byte = spi_exchange(host.dma[tx].config.read_increment ? src[i] : src[0]);
+        if (host.dma[rx].config.write_increment) {
+            dst[i] = byte;
+        } else {
+            dst[0] = byte;
+        }
+    }
+
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        if (!host.dma[i].busy) continue;
+        host.dma[i].busy = false;
+        if (host.dma[i].irq0_enabled) host.dma[i].irq0_status = true;
+    }
+    if (host.now_ns < host.dma_done_ns) host.now_ns = host.dma_done_ns;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    if (!host.dma[channel].busy) return;
+    if (host.now_ns < host.dma_done_ns) host.cpu_busy_ns += host.dma_done_ns - host.now_ns;
+    dma_run();
+}
+
+bool host_sdk_dma_complete(void) {
+    if (host.irq_disabled) fail("DMA IRQ raised with interrupts masked");
+    if (host_sdk_dma_busy()) dma_run();
+
+    bool pending = false;
+    for (int i = 0; i < MAX_CHANNELS; i++) pending |= host.dma[i].irq0_status;
+    if (!pending || !host.dma_handler) return false;
+    irq_enter();
+    host.dma_handler();
+    irq_exit();
+    return true;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    host.dma[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return host.dma[channel].irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    host.dma[channel].irq0_status = false;
+}
+
+// Transporte do modelo com a amostragem do DIO0 a cada escrita
+static void sim_write_burst(void *context, uint8_t address, const uint8_t *buffer, size_t size) {
+    LoRa_sim_transport.write_burst(context, address, buffer, size);
+    dio0_sample();
+}
+
+static void sim_read_burst(void *context, uint8_t address, uint8_t *buffer, size_t size) {
+    LoRa_sim_transport.read_burst(context, address, buffer, size);
+}
+
+static void sim_delay_us(void *context, uint32_t us) {
+    LoRa_sim_transport.delay_us(context, us);
+}
+
+static uint64_t sim_time_us(void *context) {
+    return LoRa_sim_transport.time_us(context);
+}
+
+const LoRa_transport_t host_sdk_sim_transport = {
+    sim_write_burst,
+    sim_read_burst,
+    sim_delay_us,
+    sim_time_us,
+};
+
+// Alarmes ---------------------------------------------------------------------------
+
+void host_sdk_fire_next_alarm_early(void) {
+    host.fire_early = true;
+}
+
+void host_sdk_fail_next_alarm(void) {
+    host.fail_next = true;
+}
+
+// Retorno negativo: reagenda a partir de agora; positivo: a partir do alvo anterior
+static void alarm_fire(int slot) {
+    host.alarms[slot].active = false;
+    irq_enter();
+    int64_t again = host.alarms[slot].callback(host.alarms[slot].id, host.alarms[slot].user_data);
+    irq_exit();
+    if (again < 0) {
+        host.alarms[slot].at_us = time_us_64() + (uint64_t)(-again);
+        host.alarms[slot].active = true;
+    } else if (again > 0) {
+        host.alarms[slot].at_us += (uint64_t)again;
+        host.alarms[slot].active = true;
+    }
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    if (host.fail_next) {
+        host.fail_next = false;
+        return -1;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (!host.alarms[i].active) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return -1;
+
+    host.alarms[slot].id = host.next_alarm_id++;
+    host.alarms[slot].at_us = time;
+    host.alarms[slot].callback = callback;
+    host.alarms[slot].user_data = user_data;
+
+    if (time <= time_us_64()) {
+        // No passado: o SDK chama o callback aqui mesmo e devolve 0
+        if (!fire_if_past) return 0;
+        alarm_fire(slot);
+        return host.alarms[slot].active ? host.alarms[slot].id : 0;
+    }
+
+    host.alarms[slot].active = true;
+    if (host.fire_early) {
+        host.fire_early = false;
+        host.now_ns = time * 1000;
+        alarm_fire(slot);
+    }
+    return host.alarms[slot].id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(time_us_64() + us, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (host.alarms[i].active && host.alarms[i].id == id) {
+            host.alarms[i].active = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+int host_sdk_run_alarms(uint64_t until_us) {
+    if (host.irq_disabled) fail("alarm IRQ raised with interrupts masked");
+    int fired = 0;
+    while (true) {
+        int next = -1;
+        for (int i = 0; i < MAX_ALARMS; i++) {
+            if (!host.alarms[i].active || host.alarms[i].at_us > until_us) continue;
+            if (next < 0 || host.alarms[i].at_us < host.alarms[next].at_us) next = i;
+        }
+        if (next < 0) break;
+        if (time_us_64() < host.alarms[next].at_us) host.now_ns = host.alarms[next].at_us * 1000;
+        alarm_fire(next);
+        fired++;
+    }
+    if (time_us_64() < until_us) host.now_ns = until_us * 1000;
+    return fired;
+}
+
+int host_sdk_alarms_pending(void) {
+    int pending = 0;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        if (host.alarms[i].active) pending++;
+    }
+    return pending;
+}
+
+// Multicore -----------------------------------------------------------------------
+
+void multicore_launch_core1(void (*entry)(void)) {
+    host.core1_entry = entry;
+}
+
+host_sdk_entry_t host_sdk_core1_entry(void) {
+    return host.core1_entry;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    if (host.fifo_count == FIFO_SIZE) fail("inter-core FIFO full (would block forever)");
+    host.fifo[(host.fifo_head + host.fifo_count++) % FIFO_SIZE] = data;
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    if (host.fifo_count == 0) fail("inter-core FIFO empty (would block forever)");
+    uint32_t data = host.fifo[host.fifo_head];
+    host.fifo_head = (host.fifo_head + 1) % FIFO_SIZE;
+    host.fifo_count--;
+    return data;
+}
+
+bool multicore_fifo_rvalid(void) {
+    return host.fifo_count > 0;
+}
+
+int host_sdk_fifo_count(void) {
+    return host.fifo_count;
+}
+
+// PIO (não exercitado) ------------------------------------------------------------
+
+uint pio_get_index(PIO pio) {
+    return pio == pio1 ? 1 : 0;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program) {
+    (void)pio;
+    (void)program;
+    return false;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+    (void)pio;
+    (void)program;
+    fail("PIO backend is not modelled");
+    return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    (void)pio;
+    (void)required;
+    return -1;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    (void)pio;
+    (void)sm;
+    (void)data;
+    fail("PIO backend is not modelled");
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    fail("PIO backend is not modelled");
+    return 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    return false;
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    return true;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    (void)pio;
+    (void)sm;
+    (void)div;
+}
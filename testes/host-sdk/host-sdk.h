@@ -0,0 +1,74 @@
+#ifndef HOST_SDK_H
+#define HOST_SDK_H
+
+// Controle do Pico SDK simulado. LoRa-RP2040.c é compilado sem mudanças
+// contra os cabeçalhos deste diretório: o relógio é virtual, o SPI de
+// hardware conversa com o modelo LoRa-RP2040-sim byte a byte (o pino CS
+// delimita as transações), o DMA só anda quando o teste manda e as IRQs de
+// GPIO, alarme e DMA são disparadas pelo teste, nunca sozinhas.
+
+#include "pico/stdlib.h"
+#include "LoRa-RP2040-sim.h"
+
+// Relógio em 0, nenhum alarme, DMA parado, IRQs liberadas e locks livres
+void host_sdk_reset(void);
+
+// SPI simulado ligado ao modelo; dio0 segue as flags de IRQ do modelo
+// conforme REG_DIO_MAPPING_1. Usar o modelo com spi_frequency = 0: o custo
+// de tempo do barramento fica com o relógio daqui.
+void host_sdk_attach_sim(LoRa_sim_t *sim, uint cs, uint dio0);
+
+// LoRa_sim_transport mais a amostragem do DIO0 após cada escrita (para as
+// bordas de host_sdk_dio0_update); o contexto é o LoRa_sim_t
+extern const LoRa_transport_t host_sdk_sim_transport;
+
+// Relógio virtual e tempo que o núcleo passou preso no SPI (rajadas
+// bloqueantes e esperas pelo DMA)
+void host_sdk_advance_us(uint64_t us);
+uint64_t host_sdk_cpu_busy_ns(void);
+
+// Transações (CS baixo -> alto) e bytes, incluindo o endereço
+uint32_t host_sdk_spi_transactions(void);
+uint32_t host_sdk_spi_bytes(void);
+// Chamadas spi_*_blocking: cada uma custa a entrada na função e a espera
+// das FIFOs além do tempo dos bytes
+uint32_t host_sdk_spi_calls(void);
+void host_sdk_reset_counters(void);
+
+// Reavalia o DIO0 e, numa borda de subida com a IRQ do pino ativa, chama o
+// callback do GPIO uma vez em cada núcleo que a ativou (a habilitação é por
+// núcleo, como no RP2040). Retorna true se a IRQ rodou.
+bool host_sdk_dio0_update(void);
+void host_sdk_gpio_irq(uint gpio);
+// IRQ do pino ativa no núcleo atual (host_sdk_set_core)
+bool host_sdk_gpio_irq_enabled(uint gpio);
+// Transações de SPI feitas dentro da última IRQ de GPIO, sem contar as IRQs
+// de software que ela deixou pendentes (rodam depois, com prioridade menor)
+uint32_t host_sdk_gpio_irq_transactions(void);
+
+// Avança até until_us disparando os alarmes vencidos; retorna quantos rodaram
+int host_sdk_run_alarms(uint64_t until_us);
+int host_sdk_alarms_pending(void);
+// O próximo add_alarm_* dispara o callback antes de retornar o id, como
+// uma IRQ de alarme logo após a alocação
+void host_sdk_fire_next_alarm_early(void);
+// O próximo add_alarm_* falha (-1), como com o pool de alarmes cheio
+void host_sdk_fail_next_alarm(void);
+
+// Conclui a rajada de DMA em andamento e roda o handler de DMA_IRQ_0
+bool host_sdk_dma_complete(void);
+bool host_sdk_dma_busy(void);
+
+// IRQs mascaradas (save_and_disable_interrupts) e spin locks tomados. Uma
+// IRQ de software pendente roda ao fim da IRQ de hardware atual ou quando
+// restore_interrupts libera as IRQs fora de qualquer handler.
+bool host_sdk_irq_masked(void);
+int host_sdk_locks_held(void);
+
+// Núcleo devolvido por get_core_num, para rodar código do core1 no teste
+void host_sdk_set_core(uint core);
+typedef void (*host_sdk_entry_t)(void);
+host_sdk_entry_t host_sdk_core1_entry(void);
+int host_sdk_fifo_count(void);
+
+#endif
@@ -0,0 +1,3 @@
+#ifndef HOST_SDK_PICO_BINARY_INFO_H
+#define HOST_SDK_PICO_BINARY_INFO_H
+#endif
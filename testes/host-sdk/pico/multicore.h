@@ -0,0 +1,13 @@
+#ifndef HOST_SDK_PICO_MULTICORE_H
+#define HOST_SDK_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+// O core1 não roda sozinho: o teste chama host_sdk_core1_entry() ou o
+// próprio laço do serviço; a FIFO entre núcleos é uma fila em memória
+void multicore_launch_core1(void (*entry)(void));
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_rvalid(void);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef HOST_SDK_PICO_STDLIB_H
+#define HOST_SDK_PICO_STDLIB_H
+
+// Pico SDK simulado para os testes em host (ver host-sdk.h). Só declara o
+// que LoRa-RP2040.c usa; o comportamento fica em host-sdk.c.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+#define NUM_BANK0_GPIOS 30
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t from_us_since_boot(uint64_t us);
+uint64_t to_us_since_boot(absolute_time_t t);
+bool best_effort_wfe_or_timeout(absolute_time_t deadline);
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+uint get_core_num(void);
+
+void host_sdk_wfe(void);
+
+#define __dmb()                  __sync_synchronize()
+#define __wfe()                  host_sdk_wfe()
+#define __sev()                  ((void)0)
+#define tight_loop_contents()    ((void)0)
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_SDK_SX127X_SPI_PIO_H
+#define HOST_SDK_SX127X_SPI_PIO_H
+
+// Substitui o cabeçalho gerado por pico_generate_pio_header
+#include "hardware/pio.h"
+
+static const pio_program_t sx127x_spi_program = {0};
+
+static inline void sx127x_spi_program_init(PIO pio, uint sm, uint offset, float clkdiv,
+                                           uint pin_sck, uint pin_mosi, uint pin_miso, uint pin_cs) {
+    (void)pio; (void)sm; (void)offset; (void)clkdiv;
+    (void)pin_sck; (void)pin_mosi; (void)pin_miso; (void)pin_cs;
+}
+
+#endif
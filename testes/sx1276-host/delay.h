@@ -0,0 +1,9 @@
+#ifndef __DELAY_H__
+#define __DELAY_H__
+
+#include <stdint.h>
+
+// Avança o relógio virtual; sx1276-host.c acusa chamadas dentro de IRQs
+void DelayMs( uint32_t ms );
+
+#endif
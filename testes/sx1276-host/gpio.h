@@ -0,0 +1,15 @@
+#ifndef __GPIO_H__
+#define __GPIO_H__
+
+#include <stdint.h>
+
+typedef struct
+{
+    int pin;
+    void *port;
+}Gpio_t;
+
+void GpioWrite( Gpio_t *obj, uint32_t value );
+uint32_t GpioRead( Gpio_t *obj );
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __RADIO_H__
+#define __RADIO_H__
+
+// Subconjunto do radio.h do LoRaMac-node usado por sx1276/sx1276.c
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    MODEM_FSK = 0,
+    MODEM_LORA,
+}RadioModems_t;
+
+typedef enum
+{
+    RF_IDLE = 0,
+    RF_RX_RUNNING,
+    RF_TX_RUNNING,
+    RF_CAD,
+}RadioState_t;
+
+typedef struct
+{
+    void    ( *TxDone )( void );
+    void    ( *TxTimeout )( void );
+    void    ( *RxDone )( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr );
+    void    ( *RxTimeout )( void );
+    void    ( *RxError )( void );
+    void ( *FhssChangeChannel )( uint8_t currentChannel );
+    void ( *CadDone ) ( bool channelActivityDetected );
+    void ( *GnssDone )( void );
+    void ( *WifiDone )( void );
+}RadioEvents_t;
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef __SPI_H__
+#define __SPI_H__
+
+#include <stdint.h>
+#include "gpio.h"
+
+typedef struct
+{
+    Gpio_t Nss;
+}Spi_t;
+
+uint16_t SpiInOut( Spi_t *obj, uint16_t outData );
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef __SX1276_BOARD_H__
+#define __SX1276_BOARD_H__
+
+// sx1276-board.h do LoRaMac-node (SX1276MB1LAS) para o modelo em host
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sx1276.h"
+
+#define BOARD_TCXO_WAKEUP_TIME                      0
+
+// test_sx1276_init_order troca a tabela antes de incluir sx1276.c
+#ifndef RADIO_INIT_REGISTERS_VALUE
+#define RADIO_INIT_REGISTERS_VALUE                \
+{                                                 \
+    { MODEM_FSK , REG_LNA                , 0x23 },\
+    { MODEM_FSK , REG_RXCONFIG           , 0x1E },\
+    { MODEM_FSK , REG_RSSICONFIG         , 0xD2 },\
+    { MODEM_FSK , REG_AFCFEI             , 0x01 },\
+    { MODEM_FSK , REG_PREAMBLEDETECT     , 0xAA },\
+    { MODEM_FSK , REG_OSC                , 0x07 },\
+    { MODEM_FSK , REG_SYNCCONFIG         , 0x12 },\
+    { MODEM_FSK , REG_SYNCVALUE1         , 0xC1 },\
+    { MODEM_FSK , REG_SYNCVALUE2         , 0x94 },\
+    { MODEM_FSK , REG_SYNCVALUE3         , 0xC1 },\
+    { MODEM_FSK , REG_PACKETCONFIG1      , 0xD8 },\
+    { MODEM_FSK , REG_FIFOTHRESH         , 0x8F },\
+    { MODEM_FSK , REG_IMAGECAL           , 0x02 },\
+    { MODEM_FSK , REG_DIOMAPPING1        , 0x00 },\
+    { MODEM_FSK , REG_DIOMAPPING2        , 0x30 },\
+    { MODEM_LORA, REG_LR_PAYLOADMAXLENGTH, 0x40 },\
+}
+#endif
+
+#define RF_MID_BAND_THRESH                          525000000
+
+void SX1276IoIrqInit( DioIrqHandler **irqHandlers );
+void SX1276Reset( void );
+void SX1276SetAntSwLowPower( bool status );
+void SX1276SetAntSw( uint8_t opMode );
+bool SX1276CheckRfFrequency( uint32_t frequency );
+uint32_t SX1276GetBoardTcxoWakeupTime( void );
+void SX1276SetBoardTcxo( uint8_t state );
+void SX1276SetRfTxPower( int8_t power );
+uint32_t SX1276GetDio1PinState( void );
+
+#endif
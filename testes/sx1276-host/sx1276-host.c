@@ -0,0 +1,497 @@
+#include "sx1276-host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sx1276-board.h"
+#include "timer.h"
+#include "delay.h"
+#include "utilities.h"
+
+#define MAX_TIMERS      16
+#define MAX_WRITES      1024
+#define DIO_COUNT       6
+
+static struct
+{
+    uint8_t fsk[128];
+    uint8_t lora[128];
+    uint8_t shared[128];
+    uint8_t fifo[256];
+
+    bool nss_low;
+    bool have_address;
+    bool write;
+    uint8_t addr;
+    uint32_t transactions;
+    uint32_t bytes;
+    host_sx1276_write_t writes[MAX_WRITES];
+    int nwrites;
+
+    uint32_t now_ms;
+    TimerEvent_t *timers[MAX_TIMERS];
+    int ntimers;
+    DioIrqHandler **dio;
+    int irq_depth;
+    int critical_depth;
+    uint32_t delays_in_irq;
+    uint32_t mode_switch_errors;
+    uint8_t ( *rssi )( uint32_t frequency );
+}host;
+
+static bool paged( uint8_t addr )
+{
+    return ( ( addr >= 0x02 ) && ( addr <= 0x05 ) ) || ( ( addr >= 0x0D ) && ( addr <= 0x3F ) );
+}
+
+static bool lora_mode( void )
+{
+    return ( host.shared[REG_OPMODE] & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0;
+}
+
+static uint8_t *reg( bool lora, uint8_t addr )
+{
+    addr &= 0x7F;
+    if( !paged( addr ) )
+    {
+        return &host.shared[addr];
+    }
+    return lora ? &host.lora[addr] : &host.fsk[addr];
+}
+
+void host_sx1276_reset( void )
+{
+    DioIrqHandler **dio = host.dio;
+
+    memset( &host, 0, sizeof( host ) );
+    host.dio = dio;
+    host.shared[REG_OPMODE] = 0x09;
+    host.shared[REG_FRFMSB] = 0x6C;
+    host.shared[REG_FRFMID] = 0x80;
+    host.shared[REG_PACONFIG] = 0x4F;
+    host.shared[REG_LNA] = 0x20;
+    host.shared[REG_VERSION] = 0x12;
+    host.fsk[REG_IMAGECAL] = 0x82;
+    host.lora[REG_LR_MODEMCONFIG1] = 0x72;
+    host.lora[REG_LR_MODEMCONFIG2] = 0x70;
+    host.lora[REG_LR_PREAMBLELSB] = 0x08;
+    host.lora[REG_LR_PAYLOADLENGTH] = 0x01;
+    host.lora[REG_LR_PAYLOADMAXLENGTH] = 0xFF;
+    host.lora[REG_LR_FIFOTXBASEADDR] = 0x80;
+    host.lora[REG_LR_SYNCWORD] = 0x12;
+}
+
+uint8_t host_sx1276_reg( bool lora, uint8_t addr )
+{
+    return *reg( lora, addr );
+}
+
+void host_sx1276_set_reg( bool lora, uint8_t addr, uint8_t value )
+{
+    *reg( lora, addr ) = value;
+}
+
+uint32_t host_sx1276_transactions( void )
+{
+    return host.transactions;
+}
+
+uint32_t host_sx1276_bytes( void )
+{
+    return host.bytes;
+}
+
+void host_sx1276_reset_counters( void )
+{
+    host.transactions = 0;
+    host.bytes = 0;
+    host.nwrites = 0;
+}
+
+int host_sx1276_writes( const host_sx1276_write_t **log )
+{
+    *log = host.writes;
+    return host.nwrites;
+}
+
+uint32_t host_sx1276_mode_switch_errors( void )
+{
+    return host.mode_switch_errors;
+}
+
+uint32_t host_sx1276_delays_in_irq( void )
+{
+    return host.delays_in_irq;
+}
+
+int host_sx1276_critical_depth( void )
+{
+    return host.critical_depth;
+}
+
+void host_sx1276_set_temperature( int8_t celsius )
+{
+    host.fsk[REG_TEMP] = ( uint8_t )( -celsius );
+}
+
+void host_sx1276_set_rssi( uint8_t ( *rssi )( uint32_t frequency ) )
+{
+    host.rssi = rssi;
+}
+
+void host_sx1276_lora_rx( const uint8_t *data, uint8_t size )
+{
+    uint8_t base = host.lora[REG_LR_FIFORXBASEADDR];
+
+    for( int i = 0; i < size; i++ )
+    {
+        host.fifo[( uint8_t )( base + i )] = data[i];
+    }
+    host.lora[REG_LR_FIFORXCURRENTADDR] = base;
+    host.lora[REG_LR_RXNBBYTES] = size;
+    host.lora[REG_LR_IRQFLAGS] |= RFLR_IRQFLAGS_RXDONE | RFLR_IRQFLAGS_VALIDHEADER;
+}
+
+// Registradores --------------------------------------------------------------------
+
+static uint32_t frequency( void )
+{
+    uint32_t frf = ( host.shared[REG_FRFMSB] << 16 ) | ( host.shared[REG_FRFMID] << 8 ) | host.shared[REG_FRFLSB];
+    return ( uint32_t )( ( ( uint64_t )frf * 32000000 ) >> 19 );
+}
+
+static uint8_t read_reg( uint8_t addr )
+{
+    bool lora = lora_mode( );
+
+    if( addr == REG_FIFO )
+    {
+        if( lora )
+        {
+            return host.fifo[host.lora[REG_LR_FIFOADDRPTR]++];
+        }
+        return 0;
+    }
+    if( !lora && ( addr == REG_RSSIVALUE ) && ( host.rssi != NULL ) )
+    {
+        return host.rssi( frequency( ) );
+    }
+    return *reg( lora, addr );
+}
+
+static void write_reg( uint8_t addr, uint8_t value )
+{
+    bool lora = lora_mode( );
+
+    if( host.nwrites < MAX_WRITES )
+    {
+        host.writes[host.nwrites++] = ( host_sx1276_write_t ){ lora, addr, value };
+    }
+
+    if( addr == REG_FIFO )
+    {
+        if( lora )
+        {
+            host.fifo[host.lora[REG_LR_FIFOADDRPTR]++] = value;
+        }
+        return;
+    }
+    if( addr == REG_OPMODE )
+    {
+        // LongRangeMode só é aceito em SLEEP; fora dele o bit é ignorado
+        if( ( ( value ^ host.shared[REG_OPMODE] ) & RFLR_OPMODE_LONGRANGEMODE_ON ) &&
+            ( ( host.shared[REG_OPMODE] & ~RF_OPMODE_MASK ) != RF_OPMODE_SLEEP ) )
+        {
+            host.mode_switch_errors++;
+            value = ( value & RFLR_OPMODE_LONGRANGEMODE_MASK ) | ( host.shared[REG_OPMODE] & RFLR_OPMODE_LONGRANGEMODE_ON );
+        }
+        host.shared[REG_OPMODE] = value;
+        return;
+    }
+    if( lora && ( addr == REG_LR_IRQFLAGS ) )
+    {
+        host.lora[REG_LR_IRQFLAGS] &= ~value;
+        return;
+    }
+    if( !lora && ( addr == REG_IMAGECAL ) )
+    {
+        // Calibração instantânea: RUNNING nunca fica ativo
+        host.fsk[REG_IMAGECAL] = value & ~( RF_IMAGECAL_IMAGECAL_START | RF_IMAGECAL_IMAGECAL_RUNNING );
+        return;
+    }
+    if( ( !lora && ( addr == REG_TEMP ) ) || ( addr == REG_VERSION ) )
+    {
+        // Somente leitura
+        return;
+    }
+    *reg( lora, addr ) = value;
+}
+
+// Placa ------------------------------------------------------------------------------
+
+void GpioWrite( Gpio_t *obj, uint32_t value )
+{
+    ( void )obj;
+    if( ( value == 0 ) && !host.nss_low )
+    {
+        host.nss_low = true;
+        host.have_address = false;
+        host.transactions++;
+    }
+    else if( value != 0 )
+    {
+        host.nss_low = false;
+    }
+}
+
+uint32_t GpioRead( Gpio_t *obj )
+{
+    ( void )obj;
+    return 0;
+}
+
+uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
+{
+    uint8_t data = 0;
+
+    ( void )obj;
+    host.bytes++;
+    if( !host.nss_low )
+    {
+        return 0;
+    }
+    if( !host.have_address )
+    {
+        host.have_address = true;
+        host.write = ( outData & 0x80 ) != 0;
+        host.addr = outData & 0x7F;
+        return 0;
+    }
+    if( host.write )
+    {
+        write_reg( host.addr, ( uint8_t )outData );
+    }
+    else
+    {
+        data = read_reg( host.addr );
+    }
+    if( host.addr != REG_FIFO )
+    {
+        host.addr = ( host.addr + 1 ) & 0x7F;
+    }
+    return data;
+}
+
+void SX1276IoIrqInit( DioIrqHandler **irqHandlers )
+{
+    host.dio = irqHandlers;
+}
+
+void SX1276Reset( void )
+{
+    DelayMs( 6 );
+}
+
+void SX1276SetAntSwLowPower( bool status )
+{
+    ( void )status;
+}
+
+void SX1276SetAntSw( uint8_t opMode )
+{
+    ( void )opMode;
+}
+
+bool SX1276CheckRfFrequency( uint32_t frequency )
+{
+    ( void )frequency;
+    return true;
+}
+
+uint32_t SX1276GetBoardTcxoWakeupTime( void )
+{
+    return BOARD_TCXO_WAKEUP_TIME;
+}
+
+void SX1276SetBoardTcxo( uint8_t state )
+{
+    ( void )state;
+}
+
+void SX1276SetRfTxPower( int8_t power )
+{
+    ( void )power;
+}
+
+uint32_t SX1276GetDio1PinState( void )
+{
+    return 1;
+}
+
+void host_sx1276_dio( int n )
+{
+    if( ( host.dio == NULL ) || ( n >= DIO_COUNT ) || ( host.dio[n] == NULL ) )
+    {
+        return;
+    }
+    host.irq_depth++;
+    host.dio[n]( NULL );
+    host.irq_depth--;
+}
+
+// Utilitários ------------------------------------------------------------------------
+
+void BoardCriticalSectionBegin( uint32_t *mask )
+{
+    *mask = 0;
+    host.critical_depth++;
+}
+
+void BoardCriticalSectionEnd( uint32_t *mask )
+{
+    ( void )mask;
+    if( --host.critical_depth < 0 )
+    {
+        fprintf( stderr, "sx1276-host: critical section ended twice\n" );
+        abort( );
+    }
+}
+
+void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    memcpy( dst, src, size );
+}
+
+void memset1( uint8_t *dst, uint8_t value, uint16_t size )
+{
+    memset( dst, value, size );
+}
+
+int32_t randr( int32_t min, int32_t max )
+{
+    return min + rand( ) % ( max - min + 1 );
+}
+
+void DelayMs( uint32_t ms )
+{
+    if( host.irq_depth > 0 )
+    {
+        host.delays_in_irq++;
+    }
+    host.now_ms += ms;
+}
+
+// Timers -----------------------------------------------------------------------------
+
+void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) )
+{
+    memset( obj, 0, sizeof( *obj ) );
+    obj->Callback = callback;
+    for( int i = 0; i < host.ntimers; i++ )
+    {
+        if( host.timers[i] == obj )
+        {
+            return;
+        }
+    }
+    if( host.ntimers < MAX_TIMERS )
+    {
+        host.timers[host.ntimers++] = obj;
+    }
+}
+
+void TimerSetContext( TimerEvent_t *obj, void* context )
+{
+    obj->Context = context;
+}
+
+void TimerStart( TimerEvent_t *obj )
+{
+    obj->Timestamp = host.now_ms + obj->ReloadValue;
+    obj->IsStarted = true;
+}
+
+bool TimerIsStarted( TimerEvent_t *obj )
+{
+    return obj->IsStarted;
+}
+
+void TimerStop( TimerEvent_t *obj )
+{
+    obj->IsStarted = false;
+}
+
+void TimerReset( TimerEvent_t *obj )
+{
+    TimerStop( obj );
+    TimerStart( obj );
+}
+
+void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+{
+    TimerStop( obj );
+    obj->ReloadValue = value;
+}
+
+TimerTime_t TimerGetCurrentTime( void )
+{
+    return host.now_ms;
+}
+
+TimerTime_t TimerGetElapsedTime( TimerTime_t past )
+{
+    return host.now_ms - past;
+}
+
+void host_sx1276_advance_ms( uint32_t ms )
+{
+    host.now_ms += ms;
+}
+
+int host_sx1276_timers_started( void )
+{
+    int started = 0;
+
+    for( int i = 0; i < host.ntimers; i++ )
+    {
+        started += host.timers[i]->IsStarted ? 1 : 0;
+    }
+    return started;
+}
+
+int host_sx1276_run_timers( uint32_t until_ms )
+{
+    int fired = 0;
+
+    while( true )
+    {
+        TimerEvent_t *next = NULL;
+
+        for( int i = 0; i < host.ntimers; i++ )
+        {
+            TimerEvent_t *timer = host.timers[i];
+            if( timer->IsStarted && ( timer->Timestamp <= until_ms ) &&
+                ( ( next == NULL ) || ( timer->Timestamp < next->Timestamp ) ) )
+            {
+                next = timer;
+            }
+        }
+        if( next == NULL )
+        {
+            break;
+        }
+        if( host.now_ms < next->Timestamp )
+        {
+            host.now_ms = next->Timestamp;
+        }
+        next->IsStarted = false;
+        host.irq_depth++;
+        next->Callback( next->Context );
+        host.irq_depth--;
+        fired++;
+    }
+    if( host.now_ms < until_ms )
+    {
+        host.now_ms = until_ms;
+    }
+    return fired;
+}
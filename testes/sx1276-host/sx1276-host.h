@@ -0,0 +1,58 @@
+#ifndef SX1276_HOST_H
+#define SX1276_HOST_H
+
+// Placa simulada para sx1276/sx1276.c: um SX1276 com as páginas FSK e LoRa
+// de registradores (LongRangeMode só muda em SLEEP, como no chip), o FIFO,
+// as flags de IRQ write-1-to-clear e a temperatura. Os timers do
+// LoRaMac-node andam num relógio virtual em ms e só disparam quando o teste
+// manda; os handlers de DIO e de timer rodam como IRQ, e DelayMs dentro
+// deles é contado como erro.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Registradores no valor de reset, relógio em 0, nenhum timer, contadores zerados
+void host_sx1276_reset( void );
+
+// Registrador da página pedida (0x02..0x05 e 0x0D..0x3F são paginados)
+uint8_t host_sx1276_reg( bool lora, uint8_t addr );
+void host_sx1276_set_reg( bool lora, uint8_t addr, uint8_t value );
+
+// Transações (NSS baixo -> alto) e bytes, incluindo o endereço
+uint32_t host_sx1276_transactions( void );
+uint32_t host_sx1276_bytes( void );
+void host_sx1276_reset_counters( void );
+
+// Escritas de registrador em ordem, para os testes de ordem e de imagem
+typedef struct
+{
+    bool Lora;          // página ativa no momento da escrita
+    uint8_t Addr;
+    uint8_t Value;
+}host_sx1276_write_t;
+int host_sx1276_writes( const host_sx1276_write_t **log );
+
+// Erros de uso acusados pelo modelo: troca de LongRangeMode fora de SLEEP,
+// DelayMs dentro de IRQ e seção crítica desbalanceada
+uint32_t host_sx1276_mode_switch_errors( void );
+uint32_t host_sx1276_delays_in_irq( void );
+int host_sx1276_critical_depth( void );
+
+// Relógio e timers: dispara os vencidos até until_ms, em ordem
+void host_sx1276_advance_ms( uint32_t ms );
+int host_sx1276_run_timers( uint32_t until_ms );
+int host_sx1276_timers_started( void );
+
+// Roda o handler do DIOn como IRQ
+void host_sx1276_dio( int n );
+
+// Quadro LoRa recebido: FIFO na base de RX, RXNBBYTES e RxDone
+void host_sx1276_lora_rx( const uint8_t *data, uint8_t size );
+
+// Temperatura lida em REG_TEMP (-1 °C por LSB, complemento de dois)
+void host_sx1276_set_temperature( int8_t celsius );
+
+// RSSI (REG_RSSIVALUE, FSK) em função da frequência sintonizada
+void host_sx1276_set_rssi( uint8_t ( *rssi )( uint32_t frequency ) );
+
+#endif
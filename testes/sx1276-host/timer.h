@@ -0,0 +1,32 @@
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+// timer.h do LoRaMac-node sobre o relógio virtual de sx1276-host.c (ms)
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct TimerEvent_s
+{
+    uint32_t Timestamp;
+    uint32_t ReloadValue;
+    bool IsStarted;
+    bool IsNext2Expire;
+    void ( *Callback )( void* context );
+    void* Context;
+    struct TimerEvent_s *Next;
+}TimerEvent_t;
+
+typedef uint32_t TimerTime_t;
+
+void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) );
+void TimerSetContext( TimerEvent_t *obj, void* context );
+void TimerStart( TimerEvent_t *obj );
+bool TimerIsStarted( TimerEvent_t *obj );
+void TimerStop( TimerEvent_t *obj );
+void TimerReset( TimerEvent_t *obj );
+void TimerSetValue( TimerEvent_t *obj, uint32_t value );
+TimerTime_t TimerGetCurrentTime( void );
+TimerTime_t TimerGetElapsedTime( TimerTime_t past );
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __UTILITIES_H__
+#define __UTILITIES_H__
+
+// utilities.h do LoRaMac-node: a seção crítica é contada por sx1276-host.c
+
+#include <stdint.h>
+#include <stddef.h>
+
+void BoardCriticalSectionBegin( uint32_t *mask );
+void BoardCriticalSectionEnd( uint32_t *mask );
+
+#define CRITICAL_SECTION_BEGIN( ) uint32_t mask; BoardCriticalSectionBegin( &mask )
+#define CRITICAL_SECTION_END( ) BoardCriticalSectionEnd( &mask )
+
+void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size );
+void memset1( uint8_t *dst, uint8_t value, uint16_t size );
+int32_t randr( int32_t min, int32_t max );
+
+#endif
@@ -0,0 +1,62 @@
+// AFC por par (LoRa_afc_observe): a EWMA converge para desvios pequenos nos
+// dois sentidos, sem zona morta e sem deriva, e o peso é limitado a 2^-16
+#include "LoRa-RP2040.h"
+#include "host-sdk.h"
+#include "check.h"
+
+static LoRa_t *afc_radio(uint8_t shift) {
+    static LoRa_t *lora;
+    if (!lora) lora = LoRa_init();
+    // Desligar zera os pares
+    LoRa_set_afc(lora, false, shift);
+    LoRa_set_afc(lora, true, shift);
+    return lora;
+}
+
+// Peso máximo: 300 Hz ficavam abaixo da zona morta de 4 kHz
+static void test_small_offset(void) {
+    for (int sign = -1; sign <= 1; sign += 2) {
+        LoRa_t *lora = afc_radio(16);
+        LoRa_afc_observe(lora, 1, 0);
+        for (long i = 0; i < 16 * 65536; i++) LoRa_afc_observe(lora, 1, sign * 300);
+        CHECK_EQ(LoRa_afc_offset(lora, 1), sign * 300);
+    }
+}
+
+// Degrau pequeno com peso 1/16, subindo e descendo
+static void test_step(void) {
+    LoRa_t *lora = afc_radio(4);
+    LoRa_afc_observe(lora, 2, 0);
+    for (int i = 0; i < 400; i++) LoRa_afc_observe(lora, 2, 7);
+    CHECK_EQ(LoRa_afc_offset(lora, 2), 7);
+    for (int i = 0; i < 400; i++) LoRa_afc_observe(lora, 2, -7);
+    CHECK_EQ(LoRa_afc_offset(lora, 2), -7);
+}
+
+// Medidas simétricas em volta de zero não puxam a média para baixo
+static void test_no_drift(void) {
+    LoRa_t *lora = afc_radio(8);
+    LoRa_afc_observe(lora, 3, 0);
+    for (int i = 0; i < 100000; i++) LoRa_afc_observe(lora, 3, (i & 1) ? 10 : -10);
+    long offset = LoRa_afc_offset(lora, 3);
+    CHECK(offset >= -1 && offset <= 1);
+}
+
+// shift >= 32 seria um deslocamento indefinido: limitado a 16
+static void test_shift_clamp(void) {
+    LoRa_t *lora = afc_radio(255);
+    LoRa_afc_observe(lora, 1, 1000);
+    CHECK_EQ(LoRa_afc_offset(lora, 1), 1000);
+    for (int i = 0; i < 100; i++) LoRa_afc_observe(lora, 1, 3000);
+    // 100 passos de 2000 / 65536 Hz
+    CHECK_EQ(LoRa_afc_offset(lora, 1), 1003);
+}
+
+int main(void) {
+    host_sdk_reset();
+    test_small_offset();
+    test_step();
+    test_no_drift();
+    test_shift_clamp();
+    return CHECK_DONE();
+}
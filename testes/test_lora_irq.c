@@ -0,0 +1,316 @@
+// Trabalho de SPI feito nas IRQs (GPIO, alarme, DMA) de LoRa-RP2040.c:
+// cada caso dispara as IRQs pelo host-sdk e confere o rádio e o lock do
+// barramento ao fim
+#include "LoRa-RP2040.h"
+#include "LoRa-RP2040-sim.h"
+#include "host-sdk.h"
+#include "check.h"
+
+#define SS_PIN      5
+#define DIO0_PIN    6
+
+static LoRa_sim_t sim;
+
+// Rádio novo no transporte do RP2040 (as instâncias são reaproveitadas:
+// LORA_MAX_INSTANCES limita quantas um processo pode criar)
+static LoRa_t *radio(void) {
+    static LoRa_t *lora;
+    host_sdk_reset();
+    LoRa_sim_init(&sim, 0);
+    host_sdk_attach_sim(&sim, SS_PIN, DIO0_PIN);
+    if (!lora) lora = LoRa_init();
+    LoRa_set_pins(lora, SS_PIN, -1, DIO0_PIN);
+    CHECK(LoRa_begin(lora, 868000000));
+    return lora;
+}
+
+static void check_bus_idle(void) {
+    CHECK(!host_sdk_irq_masked());
+    CHECK_EQ(host_sdk_locks_held(), 0);
+}
+
+// Fila de TX com as rajadas da FIFO por DMA: o TxDone recarrega o próximo
+// quadro na IRQ de software pendurada pela do GPIO (que fica sem SPI), e a
+// IRQ do DMA dispara o TX
+static void test_tx_queue(void) {
+    LoRa_t *lora = radio();
+    CHECK(LoRa_enable_dma(lora, NULL));
+
+    uint8_t frames[3][32];
+    for (int f = 0; f < 3; f++) {
+        memset(frames[f], 'A' + f, sizeof(frames[f]));
+        CHECK(LoRa_tx_enqueue(lora, frames[f], sizeof(frames[f])));
+    }
+    check_bus_idle();
+
+    for (int f = 0; f < 3; f++) {
+        CHECK(host_sdk_dma_complete());
+        CHECK_EQ(sim.tx_packets, f + 1);
+        uint8_t sent[32];
+        CHECK_EQ(LoRa_sim_last_tx(&sim, sent, sizeof(sent)), 32);
+        CHECK(memcmp(sent, frames[f], sizeof(sent)) == 0);
+        CHECK(host_sdk_dio0_update());
+        CHECK_EQ(host_sdk_gpio_irq_transactions(), 0);
+        check_bus_idle();
+    }
+    CHECK_EQ(LoRa_tx_queue_pending(lora), 0);
+    CHECK(!host_sdk_dma_busy());
+    LoRa_disable_dma(lora);
+}
+
+// LBT: um CAD ocupado gera backoff; o alarme refaz o CAD e o quadro sai
+static void test_lbt_backoff(void) {
+    LoRa_t *lora = radio();
+    LoRa_set_lbt(lora, true, 1000, 4);
+    LoRa_lbt_reset_stats(lora);
+
+    uint8_t frame[16] = "listen first";
+    CHECK(LoRa_tx_enqueue(lora, frame, sizeof(frame)));
+    CHECK_EQ(sim.tx_packets, 0);
+
+    // Preâmbulo detectado no primeiro CAD
+    sim.regs[0x12] |= 0x01;
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(host_sdk_alarms_pending(), 1);
+    check_bus_idle();
+
+    // Backoff vencido: novo CAD (livre) e o quadro vai ao ar
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 64000), 1);
+    check_bus_idle();
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(sim.tx_packets, 1);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(LoRa_tx_queue_pending(lora), 0);
+
+    LoRa_lbt_stats_t stats;
+    LoRa_lbt_get_stats(lora, &stats);
+    CHECK_EQ(stats.cad_runs, 2);
+    CHECK_EQ(stats.cad_busy, 1);
+    CHECK_EQ(stats.backoffs, 1);
+    LoRa_set_lbt(lora, false, 0, 0);
+}
+
+// LBT sem alarme livre para o backoff: o CAD é refeito na hora. Com a fila
+// ativa o CAD avulso é recusado, e o flush cancela o backoff armado.
+static void test_lbt_cancel(void) {
+    LoRa_t *lora = radio();
+    LoRa_set_lbt(lora, true, 1000, 4);
+    LoRa_lbt_reset_stats(lora);
+
+    uint8_t frame[16] = "no alarm";
+    CHECK(LoRa_tx_enqueue(lora, frame, sizeof(frame)));
+    sim.regs[0x12] |= 0x01;
+    host_sdk_fail_next_alarm();
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(host_sdk_alarms_pending(), 0);
+    LoRa_lbt_stats_t stats;
+    LoRa_lbt_get_stats(lora, &stats);
+    CHECK_EQ(stats.cad_runs, 2);
+    CHECK_EQ(stats.backoffs, 0);
+    check_bus_idle();
+
+    // O CAD refeito está livre: o quadro sai
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(sim.tx_packets, 1);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(LoRa_tx_queue_pending(lora), 0);
+
+    CHECK(LoRa_tx_enqueue(lora, frame, sizeof(frame)));
+    CHECK(LoRa_tx_enqueue(lora, frame, sizeof(frame)));
+    CHECK_EQ(LoRa_channel_activity_detection(lora), 0);
+    sim.regs[0x12] |= 0x01;
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(host_sdk_alarms_pending(), 1);
+    CHECK_EQ(LoRa_channel_activity_detection(lora), 0);
+
+    CHECK_EQ(LoRa_tx_queue_flush(lora), 2);
+    CHECK_EQ(host_sdk_alarms_pending(), 0);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x01);
+    CHECK(!host_sdk_gpio_irq_enabled(DIO0_PIN));
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 64000), 0);
+    CHECK_EQ(sim.tx_packets, 1);
+    check_bus_idle();
+
+    LoRa_lbt_get_stats(lora, &stats);
+    CHECK_EQ(stats.cad_runs, 3);
+    CHECK_EQ(stats.cad_busy, 2);
+    CHECK_EQ(stats.backoffs, 1);
+    LoRa_set_lbt(lora, false, 0, 0);
+
+    // Fila parada: o CAD avulso volta a ser aceito e só arma o DIO0 até o
+    // CadDone
+    CHECK_EQ(LoRa_channel_activity_detection(lora), 1);
+    CHECK(host_sdk_gpio_irq_enabled(DIO0_PIN));
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(LoRa_poll_events(lora), 1);
+    CHECK(!host_sdk_gpio_irq_enabled(DIO0_PIN));
+    check_bus_idle();
+
+    // LoRa_end com um backoff armado: nenhum alarme sobra
+    LoRa_set_lbt(lora, true, 1000, 4);
+    CHECK(LoRa_tx_enqueue(lora, frame, sizeof(frame)));
+    sim.regs[0x12] |= 0x01;
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(host_sdk_alarms_pending(), 1);
+    LoRa_end(lora);
+    CHECK_EQ(host_sdk_alarms_pending(), 0);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x00);
+    CHECK(!host_sdk_gpio_irq_enabled(DIO0_PIN));
+    CHECK_EQ(LoRa_tx_queue_pending(lora), 0);
+    check_bus_idle();
+    LoRa_set_lbt(lora, false, 0, 0);
+}
+
+// DIO0 fora do banco 0 ou já de outra instância: LoRa_begin recusa antes
+// de mexer no rádio; LoRa_end libera o pino
+static void test_dio0_owner(void) {
+    static LoRa_t *other;
+    LoRa_t *lora = radio();
+    if (!other) other = LoRa_init();
+
+    uint32_t transactions = host_sdk_spi_transactions();
+    LoRa_set_pins(other, SS_PIN, -1, DIO0_PIN);
+    CHECK(!LoRa_begin(other, 868000000));
+    LoRa_set_pins(other, SS_PIN, -1, NUM_BANK0_GPIOS);
+    CHECK(!LoRa_begin(other, 868000000));
+    LoRa_set_pins(other, SS_PIN, -1, -1);
+    CHECK(!LoRa_begin(other, 868000000));
+    CHECK_EQ(host_sdk_spi_transactions(), transactions);
+
+    LoRa_end(lora);
+    LoRa_set_pins(other, SS_PIN, -1, DIO0_PIN);
+    CHECK(LoRa_begin(other, 868000000));
+    LoRa_end(other);
+    check_bus_idle();
+}
+
+static void load_packet(LoRa_t *lora, const char *text) {
+    CHECK(LoRa_begin_packet(lora, 0));
+    LoRa_write(lora, (const uint8_t *)text, strlen(text));
+}
+
+// TX agendado: prazo que dispara antes de add_alarm_at retornar, prazo
+// normal e cancelamento
+static void test_schedule_tx(void) {
+    LoRa_t *lora = radio();
+
+    load_packet(lora, "early");
+    host_sdk_fire_next_alarm_early();
+    CHECK(LoRa_schedule_tx(lora, time_us_64() + 10));
+    CHECK_EQ(sim.tx_packets, 1);
+    check_bus_idle();
+
+    // O id do alarme já disparado não pode bloquear o próximo agendamento
+    load_packet(lora, "next");
+    CHECK(LoRa_schedule_tx(lora, time_us_64() + 5000));
+    CHECK(!LoRa_schedule_tx(lora, time_us_64() + 6000));
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 5000), 1);
+    CHECK_EQ(sim.tx_packets, 2);
+
+    load_packet(lora, "cancelled");
+    CHECK(LoRa_schedule_tx(lora, time_us_64() + 5000));
+    LoRa_cancel_scheduled_tx(lora);
+    CHECK_EQ(host_sdk_alarms_pending(), 0);
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 10000), 0);
+    CHECK_EQ(sim.tx_packets, 2);
+    CHECK(LoRa_schedule_tx(lora, time_us_64() + 100));
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 100), 1);
+    CHECK_EQ(sim.tx_packets, 3);
+    check_bus_idle();
+}
+
+// Fila de RX: os quadros saem da FIFO logo após o RxDone (na IRQ de
+// software, não na do GPIO), mesmo sem nenhum LoRa_poll_events; o excesso
+// conta como overflow na hora
+static void test_rx_queue_drain(void) {
+    LoRa_t *lora = radio();
+    LoRa_set_rx_queue(lora, true);
+    LoRa_receive(lora, 0);
+
+    char text[8];
+    for (int i = 0; i < LORA_RX_QUEUE_SLOTS + 2; i++) {
+        snprintf(text, sizeof(text), "pkt%d", i);
+        LoRa_sim_inject_rx(&sim, (const uint8_t *)text, 4, 8, 100);
+        CHECK(host_sdk_dio0_update());
+        CHECK_EQ(host_sdk_gpio_irq_transactions(), 0);
+        check_bus_idle();
+    }
+    CHECK_EQ(LoRa_rx_overflows(lora), 2);
+
+    LoRa_rx_frame_t frame;
+    for (int i = 0; i < LORA_RX_QUEUE_SLOTS; i++) {
+        snprintf(text, sizeof(text), "pkt%d", i);
+        CHECK(LoRa_rx_pop(lora, &frame));
+        CHECK_EQ(frame.length, 4);
+        CHECK(memcmp(frame.data, text, 4) == 0);
+        CHECK_EQ(frame.snr, 2);
+    }
+    CHECK(!LoRa_rx_pop(lora, &frame));
+
+    // Os eventos seguem para LoRa_poll_events sem novo acesso às flags
+    CHECK_EQ(LoRa_poll_events(lora), LORA_RX_QUEUE_SLOTS + 2);
+    CHECK_EQ(LoRa_rx_overflows(lora), 2);
+    CHECK(!LoRa_rx_pop(lora, &frame));
+    LoRa_set_rx_queue(lora, false);
+}
+
+static int sniff_received;
+
+static void sniff_on_receive(LoRa_t *lora, int size) {
+    sniff_received = size;
+}
+
+// RX com ciclo de trabalho: a janela não fecha (sleep apaga a FIFO) enquanto
+// o pacote recebido não foi lido
+static void test_sniff_unread(void) {
+    LoRa_t *lora = radio();
+    LoRa_set_on_receive(lora, sniff_on_receive);
+    CHECK(LoRa_receive_duty_cycled(lora, 2000, 8000));
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x05);
+
+    // Fim da primeira janela sem pacote: sleep
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 2000), 1);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x00);
+    // Próxima janela
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 8000), 1);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x05);
+
+    // Pacote chega; a borda ainda não foi tratada quando a janela acaba
+    LoRa_sim_inject_rx(&sim, (const uint8_t *)"wake", 4, 0, 80);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 2000), 1);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x05);
+
+    // Tratada mas só metade lida: continua em RX
+    CHECK_EQ(LoRa_poll_events(lora), 1);
+    CHECK_EQ(sniff_received, 4);
+    CHECK_EQ(LoRa_read(lora), 'w');
+    CHECK_EQ(LoRa_read(lora), 'a');
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 2000), 1);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x05);
+
+    // Tudo lido: a janela seguinte fecha
+    CHECK_EQ(LoRa_read(lora), 'k');
+    CHECK_EQ(LoRa_read(lora), 'e');
+    CHECK_EQ(host_sdk_run_alarms(time_us_64() + 2000), 1);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x00);
+    check_bus_idle();
+
+    // Parada: alarme cancelado e rádio em standby
+    LoRa_stop_duty_cycled(lora);
+    CHECK_EQ(host_sdk_alarms_pending(), 0);
+    CHECK_EQ(sim.regs[0x01] & 0x07, 0x01);
+    check_bus_idle();
+    LoRa_set_on_receive(lora, NULL);
+}
+
+int main(void) {
+    test_tx_queue();
+    test_lbt_backoff();
+    test_lbt_cancel();
+    test_dio0_owner();
+    test_schedule_tx();
+    test_rx_queue_drain();
+    test_sniff_unread();
+    return CHECK_DONE();
+}
@@ -0,0 +1,129 @@
+// Modo de serviço no core1: o teste faz o papel dos dois núcleos com
+// host_sdk_set_core e roda service_command (estático, por isso o .c é
+// incluído) para medir a latência e a vazão da fila de TX
+#include "LoRa-RP2040.c"
+#include "LoRa-RP2040-sim.h"
+#include "host-sdk.h"
+#include "check.h"
+
+#define SS_PIN      5
+#define DIO0_PIN    6
+#define BURSTS      50
+
+static LoRa_sim_t sim;
+
+// on_receive (pode ser NULL) é registrado no core0 antes do LoRa_begin
+static LoRa_t *service_radio(void (*on_receive)(LoRa_t *lora, int size)) {
+    host_sdk_reset();
+    LoRa_sim_init(&sim, 0);
+    host_sdk_attach_sim(&sim, SS_PIN, DIO0_PIN);
+
+    lora_instance_count = 0;
+    service_lora = NULL;
+    LoRa_t *lora = LoRa_init();
+    LoRa_set_pins(lora, SS_PIN, -1, DIO0_PIN);
+    LoRa_set_spi_frequency(lora, 8000000);
+    LoRa_set_on_receive(lora, on_receive);
+    LoRa_set_core1_service(lora, true);
+    CHECK(LoRa_begin(lora, 868000000));
+    CHECK(host_sdk_core1_entry() == service_main);
+
+    // Início de service_main, sem o laço infinito
+    host_sdk_set_core(1);
+    deferred_irq_init();
+    gpio_set_irq_enabled_with_callback(lora->dio0, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    LoRa_receive(lora, 0);
+    host_sdk_set_core(0);
+    return lora;
+}
+
+// O core1 atende tudo o que está na FIFO entre núcleos
+static void run_core1(LoRa_t *lora) {
+    host_sdk_set_core(1);
+    while (multicore_fifo_rvalid()) {
+        service_command(lora, multicore_fifo_pop_blocking());
+    }
+    host_sdk_set_core(0);
+}
+
+// Um segundo rádio não entra no modo de serviço nem usa a fila do primeiro
+static void test_second_radio(void) {
+    LoRa_t *lora = service_radio(NULL);
+    LoRa_t *other = LoRa_init();
+    LoRa_set_pins(other, 7, -1, 8);
+    LoRa_set_core1_service(other, true);
+    CHECK(!LoRa_begin(other, 868000000));
+    CHECK_EQ(LoRa_service_send(other, (const uint8_t *)"x", 1), 0);
+    LoRa_service_sleep(other);
+    CHECK_EQ(host_sdk_fifo_count(), 0);
+    CHECK_EQ(LoRa_service_send(lora, (const uint8_t *)"x", 1), 1);
+    CHECK_EQ(host_sdk_fifo_count(), 1);
+    run_core1(lora);
+    CHECK_EQ(sim.tx_packets, 1);
+}
+
+// Rajadas que enchem a fila: contadores dos dois núcleos, latência do
+// LoRa_service_send ao início do TX e vazão. O modelo transmite em tempo
+// zero, então os números medem só o custo do driver (SPI a 8 MHz e
+// esperas), não o tempo no ar.
+static void test_service_burst(void) {
+    LoRa_t *lora = service_radio(NULL);
+    uint8_t payload[32];
+    for (int i = 0; i < (int)sizeof(payload); i++) payload[i] = (uint8_t)i;
+
+    host_sdk_reset_counters();
+    uint64_t start_us = time_us_64();
+    for (int burst = 0; burst < BURSTS; burst++) {
+        for (int i = 0; i < LORA_SERVICE_TX_SLOTS; i++) {
+            CHECK_EQ(LoRa_service_send(lora, payload, sizeof(payload)), 1);
+        }
+        CHECK_EQ(LoRa_service_send(lora, payload, sizeof(payload)), 0);
+        run_core1(lora);
+    }
+    uint64_t elapsed_us = time_us_64() - start_us;
+
+    LoRa_service_stats_t stats;
+    LoRa_service_get_stats(lora, &stats);
+    CHECK_EQ(stats.tx_sent, BURSTS * LORA_SERVICE_TX_SLOTS);
+    CHECK_EQ(stats.tx_failed, 0);
+    CHECK_EQ(stats.tx_rejected, BURSTS);
+    CHECK_EQ(sim.tx_packets, BURSTS * LORA_SERVICE_TX_SLOTS);
+    CHECK(!host_sdk_irq_masked());
+    CHECK_EQ(host_sdk_locks_held(), 0);
+
+    printf("serviço: %u quadros de %u B em %llu us (%.0f quadros/s sem tempo no ar), "
+           "latência média %llu us, máxima %u us\n",
+           (unsigned)stats.tx_sent, (unsigned)sizeof(payload), (unsigned long long)elapsed_us,
+           stats.tx_sent * 1e6 / elapsed_us,
+           (unsigned long long)(stats.tx_latency_sum_us / stats.tx_sent), (unsigned)stats.tx_latency_max_us);
+}
+
+static void ignore_receive(LoRa_t *lora, int size) {
+    (void)lora;
+    (void)size;
+}
+
+// on_receive armou o DIO0 no core0 antes do LoRa_begin: a IRQ passa inteira
+// para o core1 e cada pacote gera um só evento e um só quadro na fila
+static void test_core0_irq_released(void) {
+    LoRa_t *lora = service_radio(ignore_receive);
+    CHECK(!host_sdk_gpio_irq_enabled(DIO0_PIN));
+    host_sdk_set_core(1);
+    CHECK(host_sdk_gpio_irq_enabled(DIO0_PIN));
+    host_sdk_set_core(0);
+
+    LoRa_sim_inject_rx(&sim, (const uint8_t *)"core1", 5, 0, 80);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(lora->events.head, 1);
+    CHECK_EQ(lora->rx_queue.head, 1);
+    CHECK_EQ(LoRa_events_dropped(lora), 0);
+    CHECK(!host_sdk_irq_masked());
+    CHECK_EQ(host_sdk_locks_held(), 0);
+}
+
+int main(void) {
+    test_second_radio();
+    test_core0_irq_released();
+    test_service_burst();
+    return CHECK_DONE();
+}
@@ -0,0 +1,90 @@
+// LoRa-RP2040.c em host: pelo transporte do modelo (LoRa_sim_transport) e
+// pelo transporte do RP2040 sobre o SPI/DMA simulados de host-sdk
+#include "LoRa-RP2040.h"
+#include "LoRa-RP2040-sim.h"
+#include "host-sdk.h"
+#include "check.h"
+
+static LoRa_sim_t sim;
+static int received;
+
+static void on_receive(LoRa_t *lora, int size) {
+    received = size;
+}
+
+// Transporte do modelo: TX bloqueante e RX pelo callback
+static void test_sim_transport(void) {
+    host_sdk_reset();
+    LoRa_sim_init(&sim, 8000000);
+    host_sdk_attach_sim(&sim, LORA_DEFAULT_SS_PIN, LORA_DEFAULT_DIO0_PIN);
+
+    LoRa_t *lora = LoRa_init();
+    LoRa_set_transport(lora, &host_sdk_sim_transport, &sim);
+    CHECK(LoRa_begin(lora, 915000000));
+
+    static const uint8_t payload[] = "hello";
+    uint8_t sent[16];
+    CHECK(LoRa_begin_packet(lora, 0));
+    CHECK_EQ(LoRa_write(lora, payload, 5), 5);
+    CHECK(LoRa_end_packet(lora, false));
+    CHECK_EQ(LoRa_sim_last_tx(&sim, sent, sizeof(sent)), 5);
+    CHECK(memcmp(sent, payload, 5) == 0);
+
+    LoRa_set_on_receive(lora, on_receive);
+    LoRa_receive(lora, 0);
+    LoRa_sim_inject_rx(&sim, (const uint8_t *)"abc", 3, 20, 100);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(LoRa_poll_events(lora), 1);
+    CHECK_EQ(received, 3);
+    CHECK_EQ(LoRa_read(lora), 'a');
+    uint8_t rest[2];
+    CHECK_EQ(LoRa_read_buffer(lora, rest, 2), 2);
+    CHECK(rest[0] == 'b' && rest[1] == 'c');
+    CHECK(!host_sdk_irq_masked());
+    CHECK_EQ(host_sdk_locks_held(), 0);
+}
+
+// Transporte do RP2040: SPI byte a byte, CS por GPIO e rajadas por DMA
+static void test_rp2040_transport(void) {
+    host_sdk_reset();
+    LoRa_sim_init(&sim, 0);
+    host_sdk_attach_sim(&sim, 5, 6);
+
+    LoRa_t *lora = LoRa_init();
+    LoRa_set_pins(lora, 5, -1, 6);
+    CHECK(LoRa_begin(lora, 868000000));
+    CHECK_EQ(LoRa_verify_shadow(lora), 0);
+
+    uint8_t payload[64];
+    for (int i = 0; i < 64; i++) payload[i] = (uint8_t)(i * 7);
+    CHECK(LoRa_enable_dma(lora, NULL));
+    CHECK(LoRa_begin_packet(lora, 0));
+    LoRa_write(lora, payload, sizeof(payload));
+    CHECK(LoRa_dma_busy(lora));
+    CHECK(host_sdk_dma_complete());
+    CHECK(!LoRa_dma_busy(lora));
+    CHECK(LoRa_end_packet(lora, false));
+    uint8_t sent[64];
+    CHECK_EQ(LoRa_sim_last_tx(&sim, sent, sizeof(sent)), 64);
+    CHECK(memcmp(sent, payload, 64) == 0);
+
+    // Um byte da FIFO (LoRa_read) não pode ir por DMA: o destino é local
+    LoRa_set_on_receive(lora, on_receive);
+    LoRa_receive(lora, 0);
+    LoRa_sim_inject_rx(&sim, (const uint8_t *)"xyz", 3, 0, 90);
+    CHECK(host_sdk_dio0_update());
+    CHECK_EQ(LoRa_poll_events(lora), 1);
+    CHECK_EQ(LoRa_read(lora), 'x');
+    CHECK(!host_sdk_dma_busy());
+    CHECK_EQ(LoRa_read(lora), 'y');
+    CHECK_EQ(LoRa_read(lora), 'z');
+    CHECK_EQ(LoRa_read(lora), -1);
+    CHECK(!host_sdk_irq_masked());
+    CHECK_EQ(host_sdk_locks_held(), 0);
+}
+
+int main(void) {
+    test_sim_transport();
+    test_rp2040_transport();
+    return CHECK_DONE();
+}
@@ -0,0 +1,114 @@
+// Tempo no ar de LoRa-RP2040.c: o recíproco dos blocos (estático, por isso
+// o .c é incluído) e LoRa_time_on_air_us contra a fórmula inteira original
+// do LoRaMac-node (toa-reference.h)
+#include "LoRa-RP2040.c"
+#include "LoRa-RP2040-sim.h"
+#include "host-sdk.h"
+#include "check.h"
+#include "toa-reference.h"
+#include <math.h>
+
+static LoRa_sim_t sim;
+
+// Maior payload em bits: 8 * 255 + 28 + 16 (CRC) com SF6
+#define MAX_BITS        (8 * 255 + 28 + 16 - 4 * 6)
+
+// ceil(x / d) pelo recíproco, para d = 16..48 de 4 em 4: o primeiro x que
+// falha fica acima dos ~21000 bits do comentário e bem acima de MAX_BITS
+static void test_block_reciprocal(void) {
+    uint32_t bound = UINT32_MAX;
+    for (uint32_t d = 16; d <= 48; d += 4) {
+        uint32_t first_bad = 0;
+        for (uint32_t x = 1; x < (1u << 20) && !first_bad; x++) {
+            uint32_t blocks = (x + d - 1) * block_reciprocal[d / 4] >> 20;
+            if (blocks != (x + d - 1) / d) first_bad = x;
+        }
+        CHECK(first_bad != 0);
+        if (first_bad < bound) bound = first_bad;
+    }
+    printf("recíproco dos blocos exato até %u bits (payload máximo %d)\n", (unsigned)(bound - 1), MAX_BITS);
+    CHECK(bound >= 21000);
+    CHECK(bound > MAX_BITS);
+}
+
+// AN1200.13 em ponto flutuante, em µs
+static double an1200_toa_us(int sf, long bw, int cr, long preamble, bool crc, bool implicit_header, int length) {
+    double symbol = (double)(1 << sf) * 1e6 / bw;
+    int de = symbol > 16000 ? 1 : 0;
+    double numerator = 8.0 * length - 4 * sf + 28 + (crc ? 16 : 0) - (implicit_header ? 20 : 0);
+    double blocks = ceil(numerator / (4 * (sf - 2 * de)));
+    double payload_symbols = 8 + (blocks > 0 ? blocks * (cr + 4) : 0);
+    return (preamble + 4.25 + payload_symbols) * symbol;
+}
+
+// Referência em µs. SF7..SF12 a 125, 250 e 500 kHz: a fórmula inteira do
+// LoRaMac-node, exata (numerador / banda). Ela não serve para SF6: segue o
+// SX126x (preâmbulo de pelo menos 12 símbolos, mais 2 símbolos e sem os 8
+// bits do cabeçalho), enquanto o datasheet do SX1276 usa para SF6 a mesma
+// fórmula dos outros SF. SF6 e as bandas estreitas, que ela não cobre,
+// ficam com o AN1200.13 em ponto flutuante.
+static double reference_us(int sf, int bw, int cr, long preamble, bool crc, bool implicit_header, int length) {
+    if (sf >= 7 && bw >= 7) {
+        uint32_t index = bw - 7;
+        uint32_t numerator = reference_numerator(index, sf, cr, preamble, implicit_header, length, crc);
+        return (double)numerator * 1e6 / reference_bandwidth_in_hz(index);
+    }
+    return an1200_toa_us(sf, bw_table[bw], cr, preamble, crc, implicit_header, length);
+}
+
+// Todas as combinações de SF, BW, CR, CRC, cabeçalho e tamanho, com dois
+// preâmbulos. O erro vem só do símbolo em Q8 (até 1/512 µs por símbolo) e
+// do truncamento final (1 µs).
+static void test_time_on_air(void) {
+    host_sdk_reset();
+    LoRa_sim_init(&sim, 0);
+    LoRa_t *lora = LoRa_init();
+    LoRa_set_transport(lora, &host_sdk_sim_transport, &sim);
+    CHECK(LoRa_begin(lora, 868000000));
+
+    static const long preambles[] = {8, 1000};
+    long combinations = 0, exact = 0;
+    double worst = 0;
+    for (int sf = 6; sf <= 12; sf++) {
+        LoRa_set_spreading_factor(lora, sf);
+        for (int bw = 0; bw < 10; bw++) {
+            LoRa_set_signal_bandwidth(lora, bw_table[bw]);
+            CHECK_EQ(LoRa_get_signal_bandwidth(lora), bw_table[bw]);
+            for (int cr = 1; cr <= 4; cr++) {
+                LoRa_set_coding_rate4(lora, cr + 4);
+                for (int p = 0; p < 2; p++) {
+                    LoRa_set_preamble_length(lora, preambles[p]);
+                    for (int flags = 0; flags < 4; flags++) {
+                        bool crc = flags & 1, implicit_header = flags & 2;
+                        if (crc) LoRa_enable_crc(lora); else LoRa_disable_crc(lora);
+                        if (implicit_header) LoRa_implicit_header_mode(lora); else LoRa_explicit_header_mode(lora);
+                        for (int length = 0; length <= 255; length++) {
+                            double expected = reference_us(sf, bw, cr, preambles[p], crc, implicit_header, length);
+                            double symbols = expected * bw_table[bw] / ((double)(1 << sf) * 1e6);
+                            double error = fabs(LoRa_time_on_air_us(lora, length) - expected);
+                            CHECK(error <= 1.0 + symbols / 512);
+                            if (error > worst) worst = error;
+                            combinations++;
+                            if (sf >= 7 && bw >= 7) exact++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("tempo no ar: %ld combinações (%ld pela fórmula inteira), erro máximo %.3f us\n", combinations, exact, worst);
+    CHECK_EQ(exact, 6 * 3 * 4 * 2 * 4 * 256);
+
+    // Acima de 2^32 µs o resultado satura em vez de dar a volta
+    LoRa_set_spreading_factor(lora, 12);
+    LoRa_set_signal_bandwidth(lora, 7800);
+    LoRa_set_preamble_length(lora, 65535);
+    CHECK_EQ(LoRa_time_on_air_us(lora, 255), UINT32_MAX);
+    CHECK_EQ(LoRa_symbols_to_us(lora, UINT32_MAX), UINT32_MAX);
+}
+
+int main(void) {
+    test_block_reciprocal();
+    test_time_on_air();
+    return CHECK_DONE();
+}
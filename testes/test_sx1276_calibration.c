@@ -0,0 +1,167 @@
+// Calibração da cadeia de RX do sx1276: a leitura de temperatura roda nos
+// passos do timer de calibração, sem DelayMs em IRQ, e converte o
+// complemento de dois de REG_TEMP sem erro de um grau
+#include <stdio.h>
+#include "sx1276-board.h"
+#include "timer.h"
+#include "sx1276-host.h"
+#include "check.h"
+
+static RadioEvents_t events;
+static uint32_t now_ms;
+static int done;
+static bool done_success;
+static TimerTime_t ready_ms;
+
+static void on_done( bool success )
+{
+    done++;
+    done_success = success;
+}
+
+static void on_ready( bool calibrated )
+{
+    on_done( calibrated );
+    ready_ms = TimerGetCurrentTime( );
+}
+
+// Dispara os timers por até 100 ms de relógio virtual
+static void run( void )
+{
+    now_ms += 100;
+    host_sx1276_run_timers( now_ms );
+}
+
+static void test_init_async( void )
+{
+    SX1276CalibrationInfo_t info;
+
+    host_sx1276_reset( );
+    now_ms = 0;
+    done = 0;
+    host_sx1276_set_temperature( 25 );
+    SX1276InitAsync( &events, on_done );
+    run( );
+    CHECK_EQ( done, 1 );
+    CHECK( done_success );
+    SX1276GetCalibrationInfo( &info );
+    CHECK( info.Valid );
+    CHECK_EQ( info.Count, 1 );
+    CHECK_EQ( info.Temperature, 25 );
+    CHECK_EQ( host_sx1276_timers_started( ), 0 );
+    CHECK_EQ( host_sx1276_delays_in_irq( ), 0 );
+    CHECK_EQ( host_sx1276_mode_switch_errors( ), 0 );
+}
+
+// Leituras em volta de zero: -( int8_t )raw, com raw = 0xFF a +1 °C
+static void test_temperature_sign( void )
+{
+    static const int8_t temperatures[] = { 10, 1, 0, -1, -10, 85, -40 };
+    SX1276CalibrationInfo_t info;
+
+    for( unsigned i = 0; i < sizeof( temperatures ) / sizeof( temperatures[0] ); i++ )
+    {
+        done = 0;
+        host_sx1276_set_temperature( temperatures[i] );
+        CHECK( SX1276CheckCalibration( 127, on_done ) );
+        // A leitura só termina no timer
+        CHECK_EQ( done, 0 );
+        run( );
+        CHECK_EQ( done, 1 );
+        CHECK( done_success );
+        SX1276GetCalibrationInfo( &info );
+        CHECK_EQ( info.LastTemperature, temperatures[i] );
+        CHECK_EQ( info.Count, 1 );
+    }
+    CHECK_EQ( host_sx1276_delays_in_irq( ), 0 );
+}
+
+// Deriva acima do limiar: recalibra no mesmo ciclo e volta a dormir
+static void test_drift_recalibrates( void )
+{
+    SX1276CalibrationInfo_t info;
+
+    done = 0;
+    host_sx1276_set_temperature( 36 );
+    CHECK( SX1276CheckCalibration( SX1276_CALIBRATION_TEMP_THRESHOLD, on_done ) );
+    CHECK( !SX1276CheckCalibration( SX1276_CALIBRATION_TEMP_THRESHOLD, on_done ) );
+    run( );
+    CHECK_EQ( done, 1 );
+    CHECK( done_success );
+    SX1276GetCalibrationInfo( &info );
+    CHECK_EQ( info.Count, 2 );
+    CHECK_EQ( info.Temperature, 36 );
+    CHECK_EQ( info.LastTemperature, 36 );
+    CHECK_EQ( host_sx1276_reg( false, REG_OPMODE ) & ~RF_OPMODE_MASK, RF_OPMODE_SLEEP );
+    CHECK_EQ( host_sx1276_delays_in_irq( ), 0 );
+    CHECK_EQ( host_sx1276_mode_switch_errors( ), 0 );
+}
+
+// A inicialização bloqueante só espera o reset: a primeira verificação
+// grava a temperatura de referência sem recalibrar
+static void test_init_blocking( void )
+{
+    SX1276CalibrationInfo_t info;
+    TimerTime_t start;
+    uint32_t reset_ms;
+    uint32_t count;
+
+    host_sx1276_reset( );
+    SX1276Reset( );
+    reset_ms = TimerGetCurrentTime( );
+
+    host_sx1276_reset( );
+    host_sx1276_set_temperature( -5 );
+    start = TimerGetCurrentTime( );
+    SX1276Init( &events );
+    CHECK_EQ( TimerGetElapsedTime( start ), reset_ms );
+    SX1276GetCalibrationInfo( &info );
+    CHECK( info.Valid );
+    CHECK( !info.TemperatureValid );
+    count = info.Count;
+
+    done = 0;
+    now_ms = TimerGetCurrentTime( );
+    CHECK( SX1276CheckCalibration( SX1276_CALIBRATION_TEMP_THRESHOLD, on_done ) );
+    run( );
+    CHECK_EQ( done, 1 );
+    CHECK( done_success );
+    SX1276GetCalibrationInfo( &info );
+    CHECK( info.TemperatureValid );
+    CHECK_EQ( info.Temperature, -5 );
+    CHECK_EQ( info.Count, count );
+    CHECK_EQ( host_sx1276_delays_in_irq( ), 0 );
+}
+
+// Tempo do boot até o rádio pronto, em relógio virtual
+static void bench_boot( void )
+{
+    uint32_t blocking_ms;
+    uint32_t transactions;
+
+    host_sx1276_reset( );
+    SX1276Init( &events );
+    blocking_ms = TimerGetCurrentTime( );
+    transactions = host_sx1276_transactions( );
+
+    host_sx1276_reset( );
+    now_ms = 0;
+    done = 0;
+    SX1276InitAsync( &events, on_ready );
+    run( );
+    CHECK_EQ( done, 1 );
+    CHECK( blocking_ms < ready_ms );
+    printf( "boot até pronto: SX1276Init %u ms, %u transações; SX1276InitAsync %u ms, %u transações\n",
+            ( unsigned )blocking_ms, ( unsigned )transactions,
+            ( unsigned )ready_ms, ( unsigned )host_sx1276_transactions( ) );
+}
+
+int main( void )
+{
+    test_init_async( );
+    test_temperature_sign( );
+    test_drift_recalibrates( );
+    test_init_blocking( );
+    bench_boot( );
+    return CHECK_DONE( );
+}
@@ -0,0 +1,112 @@
+// Carrier sense assíncrono do sx1276: o rádio fica ocupado até o onDone e
+// a contagem de amostras não dá a volta em sensoriamentos longos
+#include "sx1276-board.h"
+#include "sx1276-host.h"
+#include "check.h"
+
+static RadioEvents_t events;
+static int done;
+static uint8_t done_channels;
+static SX1276CarrierSenseResult_t *done_results;
+
+static void on_done( SX1276CarrierSenseResult_t *results, uint8_t nbChannels )
+{
+    done++;
+    done_results = results;
+    done_channels = nbChannels;
+}
+
+// 868,3 MHz ocupado (-50 dBm), os demais no ruído (-120 dBm)
+static uint8_t rssi( uint32_t frequency )
+{
+    if( ( frequency > 868200000 ) && ( frequency < 868400000 ) )
+    {
+        return 100;
+    }
+    return 240;
+}
+
+static uint8_t opmode( void )
+{
+    return host_sx1276_reg( false, REG_OPMODE ) & ~RF_OPMODE_MASK;
+}
+
+static void test_busy_while_sensing( void )
+{
+    static const uint32_t freqs[] = { 868100000, 868300000, 868500000 };
+    uint8_t payload[4] = { 1, 2, 3, 4 };
+
+    host_sx1276_reset( );
+    host_sx1276_set_rssi( rssi );
+    SX1276Init( &events );
+    SX1276SetTxConfig( MODEM_LORA, 14, 0, 0, 7, 1, 8, false, true, false, 0, false, 3000 );
+
+    done = 0;
+    CHECK( SX1276StartCarrierSense( freqs, 3, 125000, -90, 5, on_done ) );
+    CHECK_EQ( SX1276GetStatus( ), RF_RX_RUNNING );
+    CHECK( !SX1276StartCarrierSense( freqs, 1, 125000, -90, 5, on_done ) );
+
+    // Pedidos durante o sensoriamento são ignorados: o receptor FSK continua
+    SX1276Send( payload, sizeof( payload ) );
+    SX1276SetRx( 0 );
+    SX1276StartCad( );
+    SX1276SetTxContinuousWave( 868100000, 14, 1 );
+    CHECK_EQ( opmode( ), RF_OPMODE_RECEIVER );
+    CHECK_EQ( SX1276GetStatus( ), RF_RX_RUNNING );
+    CHECK_EQ( host_sx1276_mode_switch_errors( ), 0 );
+
+    host_sx1276_run_timers( 1000 );
+    CHECK_EQ( done, 1 );
+    CHECK_EQ( done_channels, 3 );
+    CHECK( done_results[0].IsFree );
+    CHECK_EQ( done_results[0].MeanRssi, -120 );
+    CHECK( done_results[0].Samples >= 5 );
+    CHECK( !done_results[1].IsFree );
+    CHECK_EQ( done_results[1].Samples, 1 );
+    CHECK_EQ( done_results[1].MaxRssi, -50 );
+    CHECK( done_results[2].IsFree );
+
+    // Terminado, o rádio volta a aceitar pedidos
+    CHECK_EQ( SX1276GetStatus( ), RF_IDLE );
+    CHECK_EQ( opmode( ), RF_OPMODE_SLEEP );
+    CHECK_EQ( host_sx1276_timers_started( ), 0 );
+    CHECK_EQ( host_sx1276_delays_in_irq( ), 0 );
+}
+
+// Mais de 65535 amostras num canal: a média continua certa
+static void test_long_sense( void )
+{
+    static const uint32_t freqs[] = { 868100000 };
+    uint32_t start = 2000;
+
+    host_sx1276_run_timers( start );
+    done = 0;
+    CHECK( SX1276StartCarrierSense( freqs, 1, 125000, -90, 70000, on_done ) );
+    host_sx1276_run_timers( start + 71000 );
+    CHECK_EQ( done, 1 );
+    CHECK( done_results[0].IsFree );
+    CHECK( done_results[0].Samples > 65535 );
+    CHECK_EQ( done_results[0].MeanRssi, -120 );
+    CHECK_EQ( done_results[0].MaxRssi, -120 );
+}
+
+// Abortado: sem callback e o rádio livre
+static void test_stop( void )
+{
+    static const uint32_t freqs[] = { 868100000 };
+
+    done = 0;
+    CHECK( SX1276StartCarrierSense( freqs, 1, 125000, -90, 50, on_done ) );
+    SX1276StopCarrierSense( );
+    CHECK_EQ( SX1276GetStatus( ), RF_IDLE );
+    host_sx1276_run_timers( 100000 );
+    CHECK_EQ( done, 0 );
+}
+
+int main( void )
+{
+    test_busy_while_sensing( );
+    test_long_sense( );
+    test_stop( );
+    return CHECK_DONE( );
+}
@@ -0,0 +1,137 @@
+// Tabela de inicialização de registradores do sx1276 em rajadas: a imagem
+// final dos registradores é a mesma da escrita um a um com SX1276SetModem
+// antes de cada entrada, e o número de transações SPI cai.
+// test_sx1276_init_order.c inclui este arquivo com SX1276_INIT_ORDER_TABLE:
+// entradas que dependem da ordem em relação às trocas de modem.
+#ifdef SX1276_INIT_ORDER_TABLE
+#define RADIO_INIT_REGISTERS_VALUE                \
+{                                                 \
+    { MODEM_FSK , REG_LNA                , 0x23 },\
+    { MODEM_FSK , REG_RXCONFIG           , 0x1E },\
+    { MODEM_FSK , REG_DIOMAPPING1        , 0x40 },\
+    { MODEM_LORA, REG_LR_PAYLOADMAXLENGTH, 0x40 },\
+    { MODEM_FSK , REG_SYNCCONFIG         , 0x12 },\
+    { MODEM_FSK , REG_RXCONFIG           , 0x1F },\
+    { MODEM_LORA, REG_LNA                , 0x20 },\
+    { MODEM_LORA, REG_LR_SYNCWORD        , 0x34 },\
+    { MODEM_LORA, REG_OPMODE             , 0x81 },\
+    { MODEM_LORA, REG_LR_PAYLOADMAXLENGTH, 0x80 },\
+    { MODEM_FSK , REG_DIOMAPPING2        , 0x10 },\
+    { MODEM_FSK , REG_FIFOTHRESH         , 0x8F },\
+    { MODEM_FSK , REG_SYNCVALUE1         , 0xC1 },\
+    { MODEM_FSK , REG_SYNCVALUE2         , 0x94 },\
+}
+#endif
+#include "sx1276.c"
+#include "sx1276-host.h"
+#include "check.h"
+
+typedef struct
+{
+    uint8_t Fsk[0x80];
+    uint8_t Lora[0x80];
+    uint32_t Transactions;
+    uint32_t Bytes;
+}image_t;
+
+static RadioEvents_t events;
+
+// Rádio recém-ressetado em SLEEP FSK, contadores zerados
+static void start( void )
+{
+    host_sx1276_reset( );
+    SX1276SetOpMode( RF_OPMODE_SLEEP );
+    host_sx1276_reset_counters( );
+}
+
+static void snapshot( image_t *image )
+{
+    image->Transactions = host_sx1276_transactions( );
+    image->Bytes = host_sx1276_bytes( );
+    for( int addr = 1; addr < 0x80; addr++ )
+    {
+        image->Fsk[addr] = host_sx1276_reg( false, addr );
+        image->Lora[addr] = host_sx1276_reg( true, addr );
+    }
+}
+
+// Escrita original do LoRaMac-node, uma entrada por vez
+static void reference_write( void )
+{
+    for( unsigned i = 0; i < RADIO_REGS_INIT_COUNT; i++ )
+    {
+        SX1276SetModem( RadioRegsInit[i].Modem );
+        SX1276Write( RadioRegsInit[i].Addr, RadioRegsInit[i].Value );
+    }
+    SX1276SetModem( MODEM_FSK );
+}
+
+static void compare( const image_t *a, const image_t *b )
+{
+    for( int addr = 1; addr < 0x80; addr++ )
+    {
+        if( ( a->Fsk[addr] != b->Fsk[addr] ) || ( a->Lora[addr] != b->Lora[addr] ) )
+        {
+            fprintf( stderr, "reg 0x%02X: fsk %02X/%02X lora %02X/%02X\n", addr,
+                     a->Fsk[addr], b->Fsk[addr], a->Lora[addr], b->Lora[addr] );
+            check_failures++;
+        }
+    }
+}
+
+static void test_same_image( void )
+{
+    image_t burst;
+    image_t reference;
+
+    SX1276Init( &events );
+
+    start( );
+    SX1276WriteRegistersInit( );
+    snapshot( &burst );
+    CHECK_EQ( host_sx1276_mode_switch_errors( ), 0 );
+
+    start( );
+    reference_write( );
+    snapshot( &reference );
+    CHECK_EQ( host_sx1276_mode_switch_errors( ), 0 );
+
+    compare( &burst, &reference );
+    CHECK( burst.Transactions < reference.Transactions );
+    CHECK( RadioRegsInitRunCount < RADIO_REGS_INIT_COUNT );
+    printf( "tabela (%u entradas, %u rajadas): %u -> %u transações, %u -> %u bytes\n",
+            ( unsigned )RADIO_REGS_INIT_COUNT, RadioRegsInitRunCount,
+            reference.Transactions, burst.Transactions, reference.Bytes, burst.Bytes );
+}
+
+// SX1276Init inteiro, com a tabela em rajadas e com a escrita um a um
+static void bench_init( void )
+{
+    image_t table;
+    image_t reference;
+    uint32_t transactions;
+    uint32_t bytes;
+
+    host_sx1276_reset( );
+    SX1276Init( &events );
+    transactions = host_sx1276_transactions( );
+    bytes = host_sx1276_bytes( );
+
+    start( );
+    SX1276WriteRegistersInit( );
+    snapshot( &table );
+    start( );
+    reference_write( );
+    snapshot( &reference );
+
+    printf( "SX1276Init: %u -> %u transações, %u -> %u bytes\n",
+            transactions - table.Transactions + reference.Transactions, transactions,
+            bytes - table.Bytes + reference.Bytes, bytes );
+}
+
+int main( void )
+{
+    test_same_image( );
+    bench_init( );
+    return CHECK_DONE( );
+}
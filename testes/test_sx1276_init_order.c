@@ -0,0 +1,5 @@
+// test_sx1276_init com uma tabela sensível à ordem: DIO mappings e OpMode
+// escritos entre trocas de modem, registrador comum declarado para LoRa e
+// registradores repetidos
+#define SX1276_INIT_ORDER_TABLE
+#include "test_sx1276_init.c"
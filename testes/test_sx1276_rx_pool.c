@@ -0,0 +1,127 @@
+// Pool de buffers de RX do sx1276: slots retidos pela camada de cima,
+// quadro descartado e contado quando o pool se esgota
+#include <string.h>
+#include "sx1276-board.h"
+#include "sx1276-host.h"
+#include "check.h"
+
+static uint8_t *held[SX1276_RX_POOL_SIZE + 1];
+static int nheld;
+static int rx_done;
+static int rx_error;
+static uint8_t last[8];
+
+static void on_rx_done( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    rx_done++;
+    memcpy( last, payload, size < sizeof( last ) ? size : sizeof( last ) );
+    if( SX1276RxBufferRetain( payload ) )
+    {
+        held[nheld++] = payload;
+    }
+}
+
+static void on_rx_error( void )
+{
+    rx_error++;
+}
+
+static RadioEvents_t events = { .RxDone = on_rx_done, .RxError = on_rx_error };
+
+static void release_all( void )
+{
+    for( int i = 0; i < nheld; i++ )
+    {
+        if( held[i] != NULL )
+        {
+            SX1276RxBufferRelease( held[i] );
+        }
+    }
+    nheld = 0;
+}
+
+static void receive( uint8_t tag )
+{
+    uint8_t frame[8];
+
+    memset( frame, tag, sizeof( frame ) );
+    host_sx1276_lora_rx( frame, sizeof( frame ) );
+    host_sx1276_dio( 0 );
+}
+
+static void test_exhausted_pool( void )
+{
+    SX1276RxPoolStats_t stats;
+
+    host_sx1276_reset( );
+    SX1276Init( &events );
+    SX1276SetRxConfig( MODEM_LORA, 0, 7, 1, 0, 8, 5, false, 0, true, false, 0, false, true );
+    SX1276SetRx( 0 );
+    SX1276ResetRxPoolStats( );
+
+    // Cada quadro fica retido: o pool enche
+    for( int i = 0; i < SX1276_RX_POOL_SIZE; i++ )
+    {
+        receive( 'a' + i );
+        CHECK_EQ( last[0], 'a' + i );
+    }
+    CHECK_EQ( nheld, SX1276_RX_POOL_SIZE );
+    CHECK_EQ( rx_error, 0 );
+
+    // Pool esgotado: o quadro é descartado sem ler o FIFO e vira RxError
+    host_sx1276_reset_counters( );
+    receive( 'x' );
+    CHECK_EQ( rx_done, SX1276_RX_POOL_SIZE );
+    CHECK_EQ( rx_error, 1 );
+    CHECK( host_sx1276_bytes( ) < 16 );
+    SX1276GetRxPoolStats( &stats );
+    CHECK_EQ( stats.Exhausted, 1 );
+    CHECK_EQ( stats.InUse, SX1276_RX_POOL_SIZE );
+
+    // Os quadros retidos continuam intactos
+    for( int i = 0; i < SX1276_RX_POOL_SIZE; i++ )
+    {
+        CHECK_EQ( held[i][0], 'a' + i );
+        CHECK_EQ( held[i][7], 'a' + i );
+    }
+
+    // Um slot liberado volta a receber
+    uint8_t *freed = held[0];
+    SX1276RxBufferRelease( freed );
+    held[0] = NULL;
+    receive( 'y' );
+    CHECK_EQ( rx_done, SX1276_RX_POOL_SIZE + 1 );
+    CHECK_EQ( last[0], 'y' );
+    CHECK( held[SX1276_RX_POOL_SIZE] == freed );
+    SX1276GetRxPoolStats( &stats );
+    CHECK_EQ( stats.HighWater, SX1276_RX_POOL_SIZE );
+    CHECK_EQ( host_sx1276_critical_depth( ), 0 );
+}
+
+// Fora de RxDone um slot já reciclado não pode ser retido
+static void test_retain_after_rx_done( void )
+{
+    SX1276RxPoolStats_t stats;
+    uint8_t *recycled;
+
+    release_all( );
+    SX1276GetRxPoolStats( &stats );
+    CHECK_EQ( stats.InUse, 0 );
+
+    // Recebido e solto sem retenção: o slot volta para o pool
+    receive( 'z' );
+    recycled = held[0];
+    SX1276RxBufferRelease( recycled );
+    nheld = 0;
+    CHECK( !SX1276RxBufferRetain( recycled ) );
+    CHECK( !SX1276RxBufferRetain( last ) );
+    SX1276GetRxPoolStats( &stats );
+    CHECK_EQ( stats.InUse, 0 );
+}
+
+int main( void )
+{
+    test_exhausted_pool( );
+    test_retain_after_rx_done( );
+    return CHECK_DONE( );
+}
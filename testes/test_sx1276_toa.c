@@ -0,0 +1,118 @@
+// Tempo no ar LoRa do sx1276 por tabela: igual, combinação a combinação, à
+// fórmula original do LoRaMac-node (numerador e divisão pela banda em Hz),
+// e o custo por chamada de cada uma
+#include <string.h>
+#include <time.h>
+#include "sx1276-board.h"
+#include "sx1276-host.h"
+#include "check.h"
+#include "toa-reference.h"
+
+// Fora de linha, como SX1276GetTimeOnAir, para a medida ser comparável
+__attribute__( ( noinline ) )
+static uint32_t reference_time_on_air( uint32_t bandwidth, uint32_t datarate, uint8_t coderate,
+                                       uint16_t preambleLen, bool fixLen, uint8_t payloadLen, bool crcOn )
+{
+    uint32_t numerator = 1000U * reference_numerator( bandwidth, datarate, coderate, preambleLen, fixLen,
+                                                      payloadLen, crcOn );
+    uint32_t denominator = reference_bandwidth_in_hz( bandwidth );
+
+    return ( numerator + denominator - 1 ) / denominator;
+}
+
+// Preâmbulo até 70 símbolos: acima disso 1000 * numerador estoura 32 bits
+// na fórmula original em SF12
+#define PREAMBLE_MAX 70
+
+static void test_equivalence( void )
+{
+    uint32_t combinations = 0;
+    uint32_t mismatches = 0;
+    uint32_t batch[SX1276_LORA_DATARATE_COUNT];
+
+    for( uint32_t bw = 0; bw <= 2; bw++ )
+    for( uint8_t cr = 1; cr <= 4; cr++ )
+    for( uint16_t preamble = 0; preamble <= PREAMBLE_MAX; preamble++ )
+    for( int flags = 0; flags < 4; flags++ )
+    for( int size = 0; size <= 255; size++ )
+    {
+        bool fixLen = ( flags & 1 ) != 0;
+        bool crcOn = ( flags & 2 ) != 0;
+
+        SX1276GetTimeOnAirBatch( bw, cr, preamble, fixLen, size, crcOn, batch );
+        for( uint32_t sf = SX1276_LORA_DATARATE_MIN; sf < SX1276_LORA_DATARATE_MIN + SX1276_LORA_DATARATE_COUNT; sf++ )
+        {
+            uint32_t expected = reference_time_on_air( bw, sf, cr, preamble, fixLen, size, crcOn );
+            uint32_t toa = SX1276GetTimeOnAir( MODEM_LORA, bw, sf, cr, preamble, fixLen, size, crcOn );
+
+            combinations++;
+            if( ( toa != expected ) || ( batch[sf - SX1276_LORA_DATARATE_MIN] != expected ) )
+            {
+                if( mismatches++ < 10 )
+                {
+                    fprintf( stderr, "bw %u sf %u cr %u pre %u fix %d crc %d len %d: %u/%u != %u\n",
+                             bw, sf, cr, preamble, fixLen, crcOn, size, toa,
+                             batch[sf - SX1276_LORA_DATARATE_MIN], expected );
+                }
+            }
+        }
+    }
+    CHECK_EQ( mismatches, 0 );
+    CHECK_EQ( combinations, 3 * 4 * ( PREAMBLE_MAX + 1 ) * 4 * 256 * SX1276_LORA_DATARATE_COUNT );
+    printf( "%u combinações, %u diferenças\n", combinations, mismatches );
+
+    // Banda reservada e SF fora da tabela: 0 em vez de dividir por zero
+    CHECK_EQ( SX1276GetTimeOnAir( MODEM_LORA, 3, 7, 1, 8, false, 10, true ), 0 );
+    CHECK_EQ( SX1276GetTimeOnAir( MODEM_LORA, 0, 4, 1, 8, false, 10, true ), 0 );
+    CHECK_EQ( SX1276GetTimeOnAir( MODEM_LORA, 0, 13, 1, 8, false, 10, true ), 0 );
+}
+
+static uint64_t now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t )ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Custo por chamada em host, sobre todas as combinações de SF, CR e tamanho
+static void bench( void )
+{
+    volatile uint32_t sink = 0;
+    uint32_t calls = 0;
+    uint64_t reference_ns;
+    uint64_t table_ns;
+    uint64_t start;
+
+    start = now_ns( );
+    for( int round = 0; round < 20; round++ )
+    for( uint32_t sf = 7; sf <= 12; sf++ )
+    for( uint8_t cr = 1; cr <= 4; cr++ )
+    for( int size = 0; size <= 255; size++ )
+    {
+        sink += reference_time_on_air( 0, sf, cr, 8, false, size, true );
+        calls++;
+    }
+    reference_ns = now_ns( ) - start;
+
+    start = now_ns( );
+    for( int round = 0; round < 20; round++ )
+    for( uint32_t sf = 7; sf <= 12; sf++ )
+    for( uint8_t cr = 1; cr <= 4; cr++ )
+    for( int size = 0; size <= 255; size++ )
+    {
+        sink += SX1276GetTimeOnAir( MODEM_LORA, 0, sf, cr, 8, false, size, true );
+    }
+    table_ns = now_ns( ) - start;
+
+    ( void )sink;
+    printf( "SX1276GetTimeOnAir: %.1f -> %.1f ns por chamada\n",
+            ( double )reference_ns / calls, ( double )table_ns / calls );
+}
+
+int main( void )
+{
+    test_equivalence( );
+    bench( );
+    return CHECK_DONE( );
+}
@@ -0,0 +1,69 @@
+#ifndef TESTES_TOA_REFERENCE_H
+#define TESTES_TOA_REFERENCE_H
+
+// Tempo no ar LoRa pela fórmula inteira original do LoRaMac-node
+// (SX1276GetLoRaTimeOnAirNumerator), referência independente para o tempo
+// no ar por tabela do sx1276 e para LoRa_time_on_air_us
+#include <stdint.h>
+#include <stdbool.h>
+
+static uint32_t reference_bandwidth_in_hz( uint32_t bw )
+{
+    switch( bw )
+    {
+    case 0: return 125000UL;
+    case 1: return 250000UL;
+    case 2: return 500000UL;
+    }
+    return 0;
+}
+
+static uint32_t reference_numerator( uint32_t bandwidth, uint32_t datarate, uint8_t coderate,
+                                     uint16_t preambleLen, bool fixLen, uint8_t payloadLen, bool crcOn )
+{
+    int32_t crDenom = coderate + 4;
+    bool lowDatareOptimize = false;
+
+    if( ( datarate == 5 ) || ( datarate == 6 ) )
+    {
+        if( preambleLen < 12 )
+        {
+            preambleLen = 12;
+        }
+    }
+
+    if( ( ( bandwidth == 0 ) && ( ( datarate == 11 ) || ( datarate == 12 ) ) ) ||
+        ( ( bandwidth == 1 ) && ( datarate == 12 ) ) )
+    {
+        lowDatareOptimize = true;
+    }
+
+    int32_t ceilDenominator;
+    int32_t ceilNumerator = ( payloadLen << 3 ) + ( crcOn ? 16 : 0 ) - ( 4 * datarate ) + ( fixLen ? 0 : 20 );
+
+    if( datarate <= 6 )
+    {
+        ceilDenominator = 4 * datarate;
+    }
+    else
+    {
+        ceilNumerator += 8;
+        ceilDenominator = ( lowDatareOptimize == true ) ? 4 * ( datarate - 2 ) : 4 * datarate;
+    }
+
+    if( ceilNumerator < 0 )
+    {
+        ceilNumerator = 0;
+    }
+
+    int32_t intermediate = ( ( ceilNumerator + ceilDenominator - 1 ) / ceilDenominator ) * crDenom + preambleLen + 12;
+
+    if( datarate <= 6 )
+    {
+        intermediate += 2;
+    }
+
+    return ( uint32_t )( ( 4 * intermediate + 1 ) * ( 1 << ( datarate - 2 ) ) );
+}
+
+#endif